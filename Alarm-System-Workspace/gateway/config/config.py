@@ -20,6 +20,7 @@ class UARTConfig:
 class TopicsConfig:
     command: str
     update: str
+    diag: str
 
 @dataclass
 class CommandsConfig:
@@ -31,7 +32,9 @@ class ProtocolConfig:
     stx: int
     etx: int
     ack: int
-    max_data_length: int
+    max_data_length: int       # Short frames (one-byte length)
+    max_ext_data_length: int   # Extended frames (16-bit length) accepted from the board
+    cobs: bool                 # Accept COBS framing when the board offers it
     encoding: str
 
 def load_config():
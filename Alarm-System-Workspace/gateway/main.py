@@ -5,6 +5,7 @@ Handles both command transmission (MQTT → UART) and telemetry reception (UART
 """
 
 import json
+import struct
 import threading
 from datetime import datetime, timezone
 from mqtt.mqtt_subscriber import MQTTSubscriber
@@ -15,6 +16,114 @@ from config.config import topics, commands, protocol as protocol_config
 import time
 import serial
 
+# Binary cloud update message (see encode_cloud_update in cloud_tasks.c)
+# type/version, flags, warn_type, alarm_state, odr_code, device_id, seq, timestamp
+CLOUD_MSG_FORMAT = "<BBBBBBHI"
+CLOUD_MSG_LEN = struct.calcsize(CLOUD_MSG_FORMAT)
+CLOUD_MSG_UPDATE = 1
+CLOUD_MSG_BATCH = 2     # [type/version][count] + count update messages
+CLOUD_MSG_BATCH_HDR_LEN = 2
+CLOUD_MSG_HELLO = 3     # [type/version][board rx max u16][link caps][nonce u32] - session start
+LINK_CAP_COBS = 0x01
+CLOUD_MSG_DIAG = 4      # [type/version] + u16 loss counters (see window_push_diag)
+CLOUD_DIAG_FORMAT = "<6H"
+CLOUD_DIAG_FIELDS = ("collapsed", "evicted", "dropped", "critical_drops",
+                     "spill_drops", "overwritten")
+CLOUD_MSG_REPORT = 5    # [type/version][section id] + section payload (see window_push_report)
+CLOUD_MSG_REPORT_HDR_LEN = 2
+CLOUD_MSG_VERSION = 1
+CLOUD_MSG_FLAG_MOTION = 0x01
+
+WARN_TYPES = ("LOW", "MED", "HIGH")
+ALARM_STATES = ("DISARMED", "ARMED", "WARN", "ALERT", "ALARM")
+
+
+def per_sensor(fmt, fields):
+    """Report section parser for fixed-size records, one per fitted sensor"""
+    size = struct.calcsize(fmt)
+
+    def parse(payload):
+        return {"sensors": [dict(zip(("device_id",) + fields, struct.unpack_from(fmt, payload, offset)))
+                            for offset in range(0, len(payload) - size + 1, size)]}
+    return parse
+
+def parse_low_power(payload):
+    """Tickless idle residency per alarm state and wake-up-to-event latency"""
+    last_wake, max_wake = struct.unpack_from("<2I", payload, 0)
+    states = {}
+    for i, offset in enumerate(range(8, len(payload) - 19, 20)):
+        total_us, sleep_us, sleeps = struct.unpack_from("<QQI", payload, offset)
+        name = ALARM_STATES[i] if i < len(ALARM_STATES) else str(i)
+        states[name] = {"total_us": total_us, "sleep_us": sleep_us, "sleeps": sleeps,
+                        "sleep_pct": round(100 * sleep_us / total_us, 1) if total_us else None}
+    return {"last_wake_to_event_us": last_wake, "max_wake_to_event_us": max_wake,
+            "states": states}
+
+def counters(fields):
+    """Report section parser for a flat list of u32 counters"""
+    fmt = f"<{len(fields)}I"
+
+    def parse(payload):
+        return dict(zip(fields, struct.unpack_from(fmt, payload, 0)))
+    return parse
+
+parse_uart_rx_counters = counters(("isr_entries", "rx_entries", "timeout_entries", "rx_bytes",
+                                   "max_batch", "overruns", "dropped", "ext_alloc_failures",
+                                   "cobs_errors"))
+
+def parse_uart_rx(payload):
+    """UART0 RX interrupt counters, plus the bytes drained per RX interrupt"""
+    stats = parse_uart_rx_counters(payload)
+    entries = stats["rx_entries"] + stats["timeout_entries"]
+    stats["bytes_per_irq"] = round(stats["rx_bytes"] / entries, 2) if entries else None
+    return stats
+
+CRC_IMPLS = ("bytewise", "slice4", "slice8", "hw")
+
+def parse_crc(payload):
+    """On-target CRC-16 benchmark: cycles per byte for each implementation"""
+    count = len(CRC_IMPLS)
+    values = struct.unpack_from(f"<{count + 2}IB", payload, 0)
+    nbytes, cycles, mismatches, hw_available = values[0], values[1:count + 1], values[-2], values[-1]
+    return {"bytes": nbytes, "mismatches": mismatches, "hw_available": bool(hw_available),
+            "cycles_per_byte": {name: round(c / nbytes, 2) if nbytes and c else None
+                                for name, c in zip(CRC_IMPLS, cycles)}}
+
+parse_uart_tx_counters = counters(("frames", "cobs_frames", "payload_bytes", "wire_bytes"))
+
+def parse_uart_tx(payload):
+    """UART0 TX framing counters, plus goodput (payload share of the bytes on the wire)"""
+    stats = parse_uart_tx_counters(payload)
+    wire = stats["wire_bytes"]
+    stats["goodput"] = round(stats["payload_bytes"] / wire, 4) if wire else None
+    return stats
+
+def parse_rings(payload):
+    """Lock-free ISR -> task rings: [name_len][name] + "<H4I" per ring"""
+    rings = []
+    offset = 0
+    while offset < len(payload):
+        name_len = payload[offset]
+        name = payload[offset + 1:offset + 1 + name_len].decode("ascii", "replace")
+        offset += 1 + name_len
+        capacity, count, pushed, drops, high_water = struct.unpack_from("<H4I", payload, offset)
+        offset += struct.calcsize("<H4I")
+        rings.append({"name": name, "capacity": capacity, "count": count, "pushed": pushed,
+                      "drops": drops, "high_water": high_water})
+    return {"rings": rings}
+
+# Report section id -> (name, payload parser), same order as the board's REPORT_SECTION_*
+REPORT_SECTIONS = {
+    0: ("dsp", per_sensor("<B4I", ("blocks", "last_cycles", "max_cycles", "over_budget"))),
+    1: ("vib", per_sensor("<B6I", ("windows", "last_cycles", "max_cycles",
+                                   "background", "tamper", "suppressed"))),
+    2: ("low_power", parse_low_power),
+    3: ("uart_rx", parse_uart_rx),
+    4: ("crc", parse_crc),
+    5: ("uart_tx", parse_uart_tx),
+    6: ("rings", parse_rings),
+}
+
 class MQTTUARTGateway:
     """Gateway bridging MQTT (cloud) and UART (embedded device) for commands and telemetry"""
 
@@ -29,7 +138,8 @@ class MQTTUARTGateway:
         self.mqtt_publisher = MQTTPublisher()
 
         # Frame parser for incoming UART data (pass serial port for ACK)
-        self.frame_parser = UARTFrameParser(self.on_update_frame_received, self.uart.ser)
+        self.frame_parser = UARTFrameParser(self.on_update_frame_received, self.uart.ser,
+                                            self.on_legacy_session)
 
         # Thread for UART RX
         self.uart_rx_thread = None
@@ -50,37 +160,115 @@ class MQTTUARTGateway:
             print(f"ERROR: Failed to parse MQTT payload: {e}")
 
     def on_update_frame_received(self, data):
-        """Handle valid update frame from board"""
+        """Handle valid update frame from board (single update or batch)"""
         try:
-            # Decode pipe-delimited string from board
-            # Format: FROM_MOTION|WARN_TYPE|ALARM_STATE
-            # Examples: "1|HIGH|WARN" (motion event) or "0||DISARMED" (command event)
-            message = data.decode(protocol_config.encoding)
-            parts = message.split('|')
-
-            if len(parts) != 3:
-                print(f"ERROR: Invalid cloud update format: {message}")
+            if data and data[0] >> 4 == CLOUD_MSG_HELLO:
+                self.on_hello_received(data)
                 return
 
-            # Parse fields
-            from_motion = int(parts[0])
-            warn_type = parts[1] if parts[1] else None  # Empty string -> None for command events
-            alarm_state = parts[2]
+            if data and data[0] >> 4 == CLOUD_MSG_DIAG:
+                self.on_diag_received(data)
+                return
 
-            # Build update object
-            update = {
-                "from_motion": from_motion,
-                "alarm_state": alarm_state,
-                "warn_type": warn_type,
-                "timestamp": datetime.now(timezone.utc).isoformat()
-            }
+            if data and data[0] >> 4 == CLOUD_MSG_REPORT:
+                self.on_report_received(data)
+                return
 
+            if data and data[0] >> 4 == CLOUD_MSG_BATCH:
+                # Board caught up after a backlog - publish each update in order
+                count = data[1]
+                offsets = [CLOUD_MSG_BATCH_HDR_LEN + i * CLOUD_MSG_LEN for i in range(count)]
+            else:
+                offsets = [0]
 
-            # Publish to MQTT as JSON
-            self.mqtt_publisher.publish(topics.update, update)
-        except (UnicodeDecodeError, ValueError, IndexError) as e:
+            for offset in offsets:
+                update = self.decode_cloud_update(data, offset)
+                if update is not None:
+                    # Publish to MQTT as JSON
+                    self.mqtt_publisher.publish(topics.update, update)
+        except (struct.error, ValueError, IndexError) as e:
             print(f"ERROR: Failed to parse cloud update data: {e}")
 
+    def on_hello_received(self, data):
+        """Board started a session - agree on the largest frame both sides accept"""
+        (board_max,) = struct.unpack_from("<H", data, 1)
+        self.uart.max_payload = max(protocol_config.max_data_length,
+                                    min(board_max, protocol_config.max_ext_data_length))
+        caps = data[3] if len(data) > 3 else 0
+        use_cobs = bool(protocol_config.cobs and caps & LINK_CAP_COBS)
+        print(f"Board HELLO: frames up to {self.uart.max_payload} bytes, "
+              f"{'COBS' if use_cobs else 'STX/ETX'} framing")
+
+        # Tell the board how large a frame we accept, in the framing it uses
+        # now; both sides switch to COBS once this reply is out. Holding the
+        # lock keeps MQTT commands from going out between the two.
+        reply = f"HELLO:{protocol_config.max_ext_data_length}"
+        with self.uart.lock:
+            self.uart.set_cobs(False)
+            self.uart.send(reply + ":COBS" if use_cobs else reply)
+            self.uart.set_cobs(use_cobs)
+
+    def on_legacy_session(self):
+        """Board restarted in STX/ETX framing - stop sending COBS before its HELLO arrives"""
+        if self.uart.cobs:
+            print("Board restarted: back to STX/ETX framing until its HELLO")
+        self.uart.set_cobs(False)
+
+    def on_diag_received(self, data):
+        """Board reported update loss counters (running totals, 16-bit wrapping)"""
+        counters = dict(zip(CLOUD_DIAG_FIELDS, struct.unpack_from(CLOUD_DIAG_FORMAT, data, 1)))
+        if counters["critical_drops"]:
+            print(f"WARNING: Board dropped {counters['critical_drops']} ALERT/ALARM updates")
+
+        # Gateway-side view of the link: goodput per framing
+        counters["link"] = self.frame_parser.link_stats
+        counters["timestamp"] = datetime.now(timezone.utc).isoformat()
+        self.mqtt_publisher.publish(topics.diag, counters)
+
+    def on_report_received(self, data):
+        """Board sent one section of its periodic subsystem statistics"""
+        section_id = data[1]
+        if section_id not in REPORT_SECTIONS:
+            print(f"ERROR: Unknown report section {section_id}")
+            return
+
+        name, parse = REPORT_SECTIONS[section_id]
+        report = parse(bytes(data[CLOUD_MSG_REPORT_HDR_LEN:]))
+        report["section"] = name
+        report["timestamp"] = datetime.now(timezone.utc).isoformat()
+        self.mqtt_publisher.publish(topics.diag, report)
+
+    @staticmethod
+    def decode_cloud_update(data, offset):
+        """Decode one binary cloud update message at offset
+
+        Returns:
+            dict ready to publish, or None if the message type/version is unknown
+        """
+        (type_version, flags, warn, state, odr_code,
+         device_id, seq, device_ts) = struct.unpack_from(CLOUD_MSG_FORMAT, data, offset)
+
+        msg_type, version = type_version >> 4, type_version & 0x0F
+        if msg_type != CLOUD_MSG_UPDATE or version != CLOUD_MSG_VERSION:
+            print(f"ERROR: Unsupported cloud update type {msg_type} version {version}")
+            return None
+
+        from_motion = 1 if flags & CLOUD_MSG_FLAG_MOTION else 0
+
+        return {
+            "from_motion": from_motion,
+            "alarm_state": ALARM_STATES[state] if state < len(ALARM_STATES) else "UNKNOWN",
+            # Command updates carry no warning
+            "warn_type": (WARN_TYPES[warn] if warn < len(WARN_TYPES) else "UNK") if from_motion else None,
+            # Sensor rate code -> Hz
+            "odr_hz": 3200 / (2 ** (15 - odr_code)),
+            # Source sensor of a motion event (0 = lid, 1 = base, 2 = plinth)
+            "device_id": device_id if from_motion else None,
+            "seq": seq,
+            "device_tick_ms": device_ts,
+            "timestamp": datetime.now(timezone.utc).isoformat()
+        }
+
     def uart_rx_loop(self):
         """Thread loop with automatic reconnection on disconnect"""
         print("UART RX thread started")
@@ -98,7 +286,8 @@ class MQTTUARTGateway:
                         print("✓ UART reconnected successfully")
                         retry_delay = 1.0  # Reset backoff on success
                         # Rebuild parser to drop stale state and bind new serial handle
-                        self.frame_parser = UARTFrameParser(self.on_update_frame_received, self.uart.ser)
+                        self.frame_parser = UARTFrameParser(self.on_update_frame_received, self.uart.ser,
+                                                            self.on_legacy_session)
                         # Flush any buffered junk from device reboot
                         try:
                             self.uart.ser.reset_input_buffer()
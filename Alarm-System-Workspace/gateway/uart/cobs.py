@@ -0,0 +1,82 @@
+"""
+COBS (Consistent Overhead Byte Stuffing)
+
+Used by the COBS link mode: every packet is COBS-encoded so it contains no
+zero byte and is terminated by a single 0x00, so a receiver resynchronises
+on the next zero after any line noise. A packet sent onto an idle line
+also starts with a 0x00 so noise picked up while idle stays separate.
+
+Packet before encoding: [kind][body...][crc_low][crc_high]
+CRC-16 covers kind and body. Kinds match uart_coms.c (COBS_KIND_*).
+"""
+
+from crc16 import CRC16
+
+DELIMITER = 0x00
+BLOCK_MAX = 254
+KIND_DATA = 0x01   # body = frame payload
+KIND_ACK = 0x02    # body = [cum][sack]
+
+
+def encode(data):
+    """COBS-encode data (no delimiter). Overhead: one byte per 254 bytes."""
+    out = bytearray()
+    block = bytearray()
+    for byte in data:
+        if byte == 0:
+            out.append(len(block) + 1)
+            out += block
+            block = bytearray()
+            continue
+        block.append(byte)
+        if len(block) == BLOCK_MAX:
+            out.append(0xFF)
+            out += block
+            block = bytearray()
+    out.append(len(block) + 1)
+    out += block
+    return bytes(out)
+
+
+def decode(data):
+    """Decode one COBS packet (delimiter stripped). Returns None if malformed."""
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            return None
+        out += data[i + 1:i + code]
+        i += code
+        # Every block but a full one and the last ends in a zero
+        if code != 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def build_packet(kind, body):
+    """Encoded, delimited packet ready to write to the port.
+
+    The gateway only sends now and then, so every packet gets a leading
+    delimiter as well.
+    """
+    packet = bytes([kind]) + bytes(body)
+    crc = CRC16.calculate(packet)
+    encoded = encode(packet + bytes([crc & 0xFF, (crc >> 8) & 0xFF]))
+    return bytes([DELIMITER]) + encoded + bytes([DELIMITER])
+
+
+def parse_packet(encoded):
+    """
+    Check one received packet (delimiter stripped).
+
+    Returns:
+        (kind, body) or None if the encoding or CRC is bad
+    """
+    packet = decode(encoded)
+    if packet is None or len(packet) < 3:
+        return None
+    crc = packet[-2] | (packet[-1] << 8)
+    if CRC16.calculate(packet[:-2]) != crc:
+        return None
+    return packet[0], packet[1:-2]
@@ -0,0 +1,110 @@
+"""
+Receive Window
+
+Reorders sequenced update frames from the board and builds the window ACKs.
+
+Every update frame starts with a header byte [SYN:1][seq:7]. The board keeps
+several frames in flight; the gateway delivers them in sequence order and
+answers each valid frame with:
+
+    [0xAA][cum][sack][cum ^ sack ^ 0x55]
+
+cum  - next sequence number expected (every earlier frame was received)
+sack - bit i set: frame cum + 1 + i is already held here
+
+A frame with SYN set starts a new session. It is only taken for a
+retransmission of the current session's SYN when it is the frame just
+delivered (seq == cum - 1) with the same payload; the board's HELLO carries
+a per-boot nonce, so a rebooted board that happens to reuse the start
+sequence number still resyncs.
+
+Only a SYN frame establishes the window. Frames that arrive with no
+session (the gateway restarted mid-session) are neither delivered nor
+ACKed: an ACK based on them could release earlier frames that never
+arrived. The parser answers them with a RESYNC request instead, and the
+board resends its window starting with a SYN frame.
+"""
+
+from config.config import protocol as protocol_config
+
+
+class ReceiveWindow:
+    """In-order delivery and cumulative/selective ACKs for sequenced frames"""
+
+    SEQ_MODULO = 128
+    SEQ_MASK = 0x7F
+    HDR_SYN = 0x80
+    SACK_BITS = 8
+    ACK_CHECK_XOR = 0x55
+
+    def __init__(self):
+        self.expected = None   # Next sequence number to deliver (None = not synced)
+        self.syn_payload = None  # Payload of the frame that started the current session
+        self.pending = {}      # Out-of-order frames waiting for the gap to fill
+
+    def receive(self, frame):
+        """
+        Accept one CRC-checked frame.
+
+        Args:
+            frame: Frame payload including the header byte
+
+        Returns:
+            list of payloads (header stripped) that are now deliverable in order
+        """
+        if not frame:
+            return []
+
+        header = frame[0]
+        seq = header & self.SEQ_MASK
+        payload = bytes(frame[1:])
+
+        # New session (board restarted, or resent its window on request)
+        if header & self.HDR_SYN and not self.is_syn_retransmit(seq, payload):
+            self.expected = seq
+            self.syn_payload = payload
+            self.pending = {}
+
+        # No session to place it in - wait for a SYN
+        if not self.synced:
+            return []
+
+        offset = (seq - self.expected) % self.SEQ_MODULO
+
+        # Within reach of the ACK bitmap: hold it until the gap before it fills.
+        # Anything else is a retransmission of a frame already delivered.
+        if offset <= self.SACK_BITS and seq not in self.pending:
+            self.pending[seq] = payload
+
+        delivered = []
+        while self.expected in self.pending:
+            delivered.append(self.pending.pop(self.expected))
+            self.expected = (self.expected + 1) % self.SEQ_MODULO
+
+        return delivered
+
+    @property
+    def synced(self):
+        """True once a SYN frame has established the window"""
+        return self.expected is not None
+
+    def is_syn_retransmit(self, seq, payload):
+        """True if a SYN frame repeats the one that started this session (its ACK was lost)"""
+        return (self.expected is not None
+                and seq == (self.expected - 1) % self.SEQ_MODULO
+                and payload == self.syn_payload)
+
+    def ack_fields(self):
+        """(cum, sack) for the current window state"""
+        cum = self.expected if self.expected is not None else 0
+        sack = 0
+        for i in range(self.SACK_BITS):
+            if (cum + 1 + i) % self.SEQ_MODULO in self.pending:
+                sack |= 1 << i
+
+        return cum, sack
+
+    def build_ack(self):
+        """Build the STX/ETX-mode ACK for the current window state"""
+        cum, sack = self.ack_fields()
+        return bytes([protocol_config.ack, cum, sack, cum ^ sack ^ self.ACK_CHECK_XOR])
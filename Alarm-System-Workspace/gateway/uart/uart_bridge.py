@@ -1,6 +1,7 @@
 import serial
+import threading
 import time
-from config.config import uart as uart_config
+from config.config import uart as uart_config, protocol as protocol_config
 from uart.port_detector import MAX32655PortDetector
 from uart.uart_frame_builder import FrameBuilder
 
@@ -19,6 +20,13 @@ class UARTBridge:
             self.port = None
 
         self.baudrate = uart_config.baudrate
+        # Largest payload the board accepts - raised by its HELLO
+        self.max_payload = protocol_config.max_data_length
+        # COBS framing agreed in the board's HELLO. The RX thread changes
+        # it while MQTT callbacks send: both hold lock (re-entrant, so a
+        # framing switch can send its reply and flip the flag atomically)
+        self.lock = threading.RLock()
+        self.cobs = False
         self.ser = None
         self.connected = False
         self._connect()
@@ -31,6 +39,8 @@ class UARTBridge:
                 self.ser.close()
 
             self.ser = serial.Serial(self.port, self.baudrate, timeout=1)
+            # The board may have restarted - STX/ETX until it says HELLO again
+            self.set_cobs(False)
             # Flush buffers after opening to avoid stale data
             try:
                 self.ser.reset_input_buffer()
@@ -79,11 +89,16 @@ class UARTBridge:
             except:
                 pass  # Ignore errors during disconnect
 
+    def set_cobs(self, enabled):
+        """Switch the framing used by send()"""
+        with self.lock:
+            self.cobs = enabled
+
     def send(self, command):
         """Send a command over UART using binary protocol
 
         Args:
-            command: String command ("ARM", "DISARM", or "RESOLVE")
+            command: String command ("ARM", "DISARM", or "RESOLVE") or raw bytes
 
         Returns:
             bool: True if send successful, False otherwise
@@ -93,8 +108,16 @@ class UARTBridge:
                 print("✗ Cannot send: UART not connected")
                 return False
 
-            frame = FrameBuilder.build_frame(command)
-            self.ser.write(frame)
+            if len(command) > self.max_payload:
+                print(f"✗ Cannot send: {len(command)} bytes exceeds board limit of {self.max_payload}")
+                return False
+
+            with self.lock:
+                if self.cobs:
+                    frame = FrameBuilder.build_cobs_frame(command)
+                else:
+                    frame = FrameBuilder.build_frame(command)
+                self.ser.write(frame)
             print(f"✓ Sent to UART: {command} (frame: {frame.hex()})")
             return True
 
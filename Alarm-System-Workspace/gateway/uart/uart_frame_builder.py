@@ -6,6 +6,7 @@ Handles construction of binary frames with STX/ETX framing and CRC-16 checksums.
 
 from config.config import protocol as protocol_config
 from crc16 import CRC16
+from uart import cobs
 
 
 class FrameBuilder:
@@ -17,19 +18,26 @@ class FrameBuilder:
         Build a binary frame with STX/ETX framing and CRC-16.
 
         Frame format: [STX][length][data][crc_low][crc_high][ETX]
+        Payloads over max_data_length use the extended format
+        [STX][0][len_low][len_high][data][crc_low][crc_high][ETX]
 
         Args:
-            command: String command ("ARM", "DISARM", or "RESOLVE")
+            command: String command ("ARM", "DISARM", or "RESOLVE") or raw bytes
 
         Returns:
             bytes object containing complete frame
         """
         # Convert command to bytes
-        data = command.encode(protocol_config.encoding)
+        data = command.encode(protocol_config.encoding) if isinstance(command, str) else bytes(command)
         length = len(data)
 
+        if length <= protocol_config.max_data_length:
+            length_field = bytes([length])
+        else:
+            length_field = bytes([0, length & 0xFF, (length >> 8) & 0xFF])
+
         # Build CRC payload: length + data
-        crc_payload = bytes([length]) + data
+        crc_payload = length_field + data
 
         # Calculate CRC using CRC16 module
         crc = CRC16.calculate(crc_payload)
@@ -37,6 +45,20 @@ class FrameBuilder:
         crc_high = (crc >> 8) & 0xFF
 
         # Build complete frame using protocol config
-        frame = bytes([protocol_config.stx, length]) + data + bytes([crc_low, crc_high, protocol_config.etx])
+        frame = bytes([protocol_config.stx]) + length_field + data + bytes([crc_low, crc_high, protocol_config.etx])
 
         return frame
+
+    @staticmethod
+    def build_cobs_frame(command):
+        """
+        Build a COBS data packet (COBS link mode, see cobs.py).
+
+        Args:
+            command: String command or raw bytes
+
+        Returns:
+            bytes object containing the encoded packet and its zero delimiter
+        """
+        data = command.encode(protocol_config.encoding) if isinstance(command, str) else bytes(command)
+        return cobs.build_packet(cobs.KIND_DATA, data)
@@ -3,17 +3,26 @@ UART Frame Parser
 
 State machine parser for incoming UART frames with STX/ETX framing.
 Frame format: [STX][length][data...][crc_low][crc_high][ETX]
+Extended:     [STX][0][len_low][len_high][data...][crc_low][crc_high][ETX]
+COBS packets (see cobs.py) are decoded alongside; ACKs go back in the
+framing of the frame they acknowledge.
+Update frames carry a sequence header; see receive_window.py.
 """
 
+import time
 import serial
 from crc16 import CRC16
 from config.config import protocol as protocol_config
+from uart.receive_window import ReceiveWindow
+from uart.uart_frame_builder import FrameBuilder
+from uart import cobs
 
 class UARTFrameParser:
     """
     State machine parser for incoming UART frames with STX/ETX framing.
 
     Frame format: [STX][length][data...][crc_low][crc_high][ETX]
+    Length 0 introduces an extended frame with a 16-bit little-endian length.
     """
 
     # Parser states
@@ -23,25 +32,51 @@ class UARTFrameParser:
     STATE_READ_CRC_LOW = 3
     STATE_READ_CRC_HIGH = 4
     STATE_WAIT_ETX = 5
+    STATE_READ_EXT_LEN_LOW = 6
+    STATE_READ_EXT_LEN_HIGH = 7
 
-    def __init__(self, on_frame_received, serial_port=None):
+    # Link-level request for the board to resend its window from a SYN frame
+    RESYNC_REQUEST = "RESYNC"
+    RESYNC_INTERVAL = 0.5  # Seconds - one request covers a whole window of resends
+
+    def __init__(self, on_frame_received, serial_port=None, on_legacy_session=None):
         """
         Initialize parser.
 
         Args:
-            on_frame_received: Callback function(data: bytes) called when valid frame received
+            on_frame_received: Callback function(data: bytes) called for each update, in sequence order
             serial_port: Serial port object for sending ACK (optional)
+            on_legacy_session: Callback function() called when a SYN frame arrives in
+                STX/ETX framing - the board (re)started and speaks STX/ETX until its HELLO
         """
         self.on_frame_received = on_frame_received
+        self.on_legacy_session = on_legacy_session
         self.serial_port = serial_port
         self.state = self.STATE_WAIT_STX
         self.data_buffer = bytearray()
         self.data_length = 0
         self.data_index = 0
         self.received_crc = 0
+        self.length_field = b""  # Length byte(s) as sent - covered by the CRC
+        self.window = ReceiveWindow()
+        self.last_resync = None
+
+        # COBS packet being collected (everything up to the next zero)
+        self.cobs_buffer = bytearray()
+        # Board's last good frame was COBS: STX/ETX frames are then only
+        # believed if they start a new session (board restarted)
+        self.cobs_peer = False
+
+        # Received frames per framing, for goodput = payload_bytes / wire_bytes
+        self.link_stats = {
+            framing: {"frames": 0, "payload_bytes": 0, "wire_bytes": 0, "errors": 0}
+            for framing in ("legacy", "cobs")
+        }
 
     def process_byte(self, byte):
         """Process single byte from UART"""
+        self.process_cobs_byte(byte)
+
         if self.state == self.STATE_WAIT_STX:
             if byte == protocol_config.stx:
                 self.state = self.STATE_READ_LENGTH
@@ -50,14 +85,31 @@ class UARTFrameParser:
         elif self.state == self.STATE_READ_LENGTH:
             self.data_length = byte
             self.data_index = 0
+            self.length_field = bytes([byte])
             # length must be greater than 0 and within max limit
             if self.data_index < self.data_length <= protocol_config.max_data_length:
                 self.state = self.STATE_READ_DATA
+            elif self.data_length == 0:
+                # Extended frame - 16-bit length follows
+                self.state = self.STATE_READ_EXT_LEN_LOW
             else:
                 # Invalid length
                 # Reset to wait for next frame
                 self.state = self.STATE_WAIT_STX
 
+        elif self.state == self.STATE_READ_EXT_LEN_LOW:
+            self.data_length = byte
+            self.length_field += bytes([byte])
+            self.state = self.STATE_READ_EXT_LEN_HIGH
+
+        elif self.state == self.STATE_READ_EXT_LEN_HIGH:
+            self.data_length |= byte << 8
+            self.length_field += bytes([byte])
+            if protocol_config.max_data_length < self.data_length <= protocol_config.max_ext_data_length:
+                self.state = self.STATE_READ_DATA
+            else:
+                self.state = self.STATE_WAIT_STX
+
         elif self.state == self.STATE_READ_DATA:
             self.data_buffer.append(byte)
             self.data_index += 1
@@ -76,24 +128,94 @@ class UARTFrameParser:
         elif self.state == self.STATE_WAIT_ETX:
             if byte == protocol_config.etx:
                 # Validate CRC
-                crc_payload = bytes([self.data_length]) + bytes(self.data_buffer)
+                crc_payload = self.length_field + bytes(self.data_buffer)
                 calculated_crc = CRC16.calculate(crc_payload)
 
-                if calculated_crc == self.received_crc:
-                    # Valid frame - invoke callback
-                    self.on_frame_received(bytes(self.data_buffer))
-
-                    # Send ACK byte back to board
-                    self.send_ack()
+                session_start = self.data_buffer and self.data_buffer[0] & ReceiveWindow.HDR_SYN
+                if calculated_crc == self.received_crc and (not self.cobs_peer or session_start):
+                    if session_start and self.on_legacy_session:
+                        self.on_legacy_session()
+                    wire = 1 + len(self.length_field) + len(self.data_buffer) + 3
+                    self.on_valid_frame(bytes(self.data_buffer), "legacy", wire)
 
             # Always reset to wait for next frame
             self.state = self.STATE_WAIT_STX
 
-    def send_ack(self):
-        """Send ACK byte back to board"""
+    def process_cobs_byte(self, byte):
+        """Collect COBS packets; a zero byte always ends one"""
+        if byte != cobs.DELIMITER:
+            # Nothing valid is longer than the largest extended frame
+            if len(self.cobs_buffer) <= protocol_config.max_ext_data_length + cobs.BLOCK_MAX:
+                self.cobs_buffer.append(byte)
+            return
+
+        if not self.cobs_buffer:
+            return
+
+        encoded = bytes(self.cobs_buffer)
+        self.cobs_buffer = bytearray()
+
+        packet = cobs.parse_packet(encoded)
+        if packet is None:
+            # Legacy traffic lands here too, so only count once the board speaks COBS
+            if self.cobs_peer:
+                self.link_stats["cobs"]["errors"] += 1
+            return
+
+        kind, body = packet
+        if kind == cobs.KIND_DATA and body:
+            self.on_valid_frame(body, "cobs", len(encoded) + 1)
+
+    def on_valid_frame(self, data, framing, wire_length):
+        """CRC-checked frame from either framing"""
+        self.cobs_peer = framing == "cobs"
+
+        stats = self.link_stats[framing]
+        stats["frames"] += 1
+        stats["payload_bytes"] += len(data)
+        stats["wire_bytes"] += wire_length
+
+        delivered = self.window.receive(data)
+
+        if not self.window.synced:
+            # Mid-session frame after a gateway restart: never ACK it
+            self.request_resync(framing == "cobs")
+            return
+
+        # ACK every valid frame, duplicates included, so lost ACKs recover.
+        # ACK before delivering: a HELLO reply sent from the callback can
+        # switch the board to COBS, after which it ignores STX/ETX ACKs.
+        self.send_ack(framing == "cobs")
+
+        for payload in delivered:
+            self.on_frame_received(payload)
+
+    def request_resync(self, use_cobs=False):
+        """Ask the board to restart the window from its oldest frame (rate limited)"""
+        now = time.monotonic()
+        if self.last_resync is not None and now - self.last_resync < self.RESYNC_INTERVAL:
+            return
+        self.last_resync = now
+
+        if self.serial_port:
+            try:
+                if use_cobs:
+                    request = FrameBuilder.build_cobs_frame(self.RESYNC_REQUEST)
+                else:
+                    request = FrameBuilder.build_frame(self.RESYNC_REQUEST)
+                self.serial_port.write(request)
+            except (serial.SerialException, OSError):
+                pass
+
+    def send_ack(self, use_cobs=False):
+        """Send cumulative/selective window ACK back to board"""
         if self.serial_port:
             try:
-                self.serial_port.write(bytes([protocol_config.ack]))
+                if use_cobs:
+                    ack = cobs.build_packet(cobs.KIND_ACK, self.window.ack_fields())
+                else:
+                    ack = self.window.build_ack()
+                self.serial_port.write(ack)
             except (serial.SerialException, OSError):
                 # Port disconnected - ACK will fail silently
                 # Reconnection will be handled by RX loop
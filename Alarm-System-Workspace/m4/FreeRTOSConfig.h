@@ -39,12 +39,26 @@
 /* CMSIS keeps a global updated with current system clock in Hz */
 #define configCPU_CLOCK_HZ ((uint32_t)IPO_FREQ)
 
-// #define configUSE_TICKLESS_IDLE     1
+// Sleep between events; hooks live in src/utils/low_power.c
+#define configUSE_TICKLESS_IDLE     1
 
 #define configTICK_RATE_HZ ((portTickType)1000)
 #define configRTC_TICK_RATE_HZ (32768)
 
-#define configTOTAL_HEAP_SIZE ((size_t)(26 * 1024))
+/*
+ * Every task, stack, queue, semaphore, timer and stream buffer is placed
+ * statically (see `make ram-report`). The heap only backs the UART
+ * extended frame buffers; STATIC_ALLOC=1 (project.mk) removes it
+ * entirely and those buffers come from a static pool instead.
+ */
+#define configSUPPORT_STATIC_ALLOCATION 1
+#if defined(APP_STATIC_ALLOC) && APP_STATIC_ALLOC
+#define configSUPPORT_DYNAMIC_ALLOCATION 0
+#define configTOTAL_HEAP_SIZE ((size_t)0)
+#else
+#define configSUPPORT_DYNAMIC_ALLOCATION 1
+#define configTOTAL_HEAP_SIZE ((size_t)(6 * 1024))
+#endif
 
 #define configMINIMAL_STACK_SIZE ((uint16_t)128)
 
@@ -55,18 +69,17 @@
 #define configUSE_CO_ROUTINES 0
 #define configUSE_16_BIT_TICKS 0
 #define configUSE_MUTEXES 1
+#define configUSE_RECURSIVE_MUTEXES 1
 #define configUSE_COUNTING_SEMAPHORES 1
-#define configUSE_QUEUE_SETS 1
+#define configUSE_QUEUE_SETS 0
 
 
-/* Enable software timers and queue sets (used by AlertControlTask) */
+/* Enable software timers (WARN timeout in AlertControlTask) */
 #define configUSE_TIMERS 1
 #define configTIMER_TASK_PRIORITY    (tskIDLE_PRIORITY + 2)
 #define configTIMER_QUEUE_LENGTH     10
 #define configTIMER_TASK_STACK_DEPTH (configMINIMAL_STACK_SIZE * 2)
 
-#define configUSE_QUEUE_SETS 1
-
 /* Run time and task stats gathering related definitions. */
 #define configUSE_TRACE_FACILITY 1
 #define configUSE_STATS_FORMATTING_FUNCTIONS 1
@@ -79,6 +92,8 @@ to exclude the API function. */
 #define INCLUDE_vTaskDelayUntil 1
 #define INCLUDE_uxTaskPriorityGet 0
 #define INCLUDE_vTaskDelay 1
+#define INCLUDE_xTaskGetSchedulerState 1
+#define INCLUDE_xTaskGetCurrentTaskHandle 1
 
 /* # of priority bits (configured in hardware) is provided by CMSIS */
 #define configPRIO_BITS __NVIC_PRIO_BITS
@@ -42,8 +42,20 @@ PROJ_CFLAGS += -fdump-ipa-cgraph
 PROJ_CFLAGS += -fstack-usage
 PROJ_CFLAGS += -gdwarf-4
 
+# CMSIS-DSP Q15 kernels for the motion feature pipeline
+LIB_CMSIS_DSP = 1
+
 FREERTOS_SRC += \
-    $(FREERTOS_DIR)/Source/timers.c
+    $(FREERTOS_DIR)/Source/timers.c \
+    $(FREERTOS_DIR)/Source/stream_buffer.c
 
 # Use the generated linker file from the project
 LINKERFILE = memory.ld
+
+# STATIC_ALLOC=1: build without a FreeRTOS heap. Kernel objects are always
+# statically placed; this also takes the UART extended frame buffers off
+# the heap, and any remaining dynamic allocation fails to link.
+STATIC_ALLOC ?= 0
+ifeq ($(STATIC_ALLOC), 1)
+PROJ_CFLAGS += -DAPP_STATIC_ALLOC=1
+endif
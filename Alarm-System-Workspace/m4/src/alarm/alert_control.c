@@ -6,11 +6,14 @@
 #include "alert_outputs.h"
 #include "led_driver.h"
 #include "../utils/queues.h"
-
-QueueSetHandle_t alert_queue_set;
-#define SET_LENGTH (MOTION_QUEUE_LENGTH + COMMAND_QUEUE_LENGTH)
+#include "../motion/adxl343_motion.h"
+#include "../utils/low_power.h"
+#include "../utils/flash_log.h"
+#include "../utils/cloud_buffer.h"
+#include "../utils/event_bus.h"
 
 static TimerHandle_t warn_timeout_timer;
+static StaticTimer_t warn_timeout_timer_buffer;
 
 
 // Drive the physical alerts for the current state. 
@@ -66,24 +69,80 @@ static alarm_event command_to_alarm_event(command_type cmd) {
     }
 }
 
-// Send update to cloud_update_queue, dropping oldest if queue full
+// Publish an update for the cloud task. Overflow goes to the flash log,
+// where ALERT/ALARM updates have reserved room and may wait briefly for
+// the writer (nothing else blocks). Only with no backlog in the log can
+// the RAM buffer make room by priority (ALERT/ALARM updates are kept).
 int send_cloud_update(cloud_update_event* update) {
-    // Try to send with timeout
-    if (xQueueSend(cloud_update_queue, update, pdMS_TO_TICKS(100)) != pdPASS) {
-        // Queue full - drop oldest message to make room
-        cloud_update_event discarded;
-        xQueueReceive(cloud_update_queue, &discarded, 0);
-
-        // Retry sending new update (succeeds now)
-        xQueueSend(cloud_update_queue, update, 0);
+    bool backlog = flash_log_active();
+
+    if (!backlog && cloud_buffer_push(update)) {
+        return pdPASS;
+    }
+    if (flash_log_spill(update)) {
+        return pdPASS;
+    }
+
+    // Going into RAM would overtake the backlog: the gateway must see
+    // updates in order, so the update is lost (counted in spill_drops)
+    if (backlog) {
+        return pdFAIL;
     }
-    return pdPASS;
+    return cloud_buffer_publish(update) ? pdPASS : pdFAIL;
 }
 
-// Callback - sends CANCEL_WARN command_event
+// Callback - publishes CANCEL_WARN into the bus slot held back for it
 static void warn_timeout_callback(TimerHandle_t xTimer) {
-    command_event cancel_cmd = {.cmd = CANCEL_WARN};
-    xQueueSend(command_queue, &cancel_cmd, 0);
+    alert_event cancel = {
+        .source = EVENT_SOURCE_COMMAND,
+        .timestamp = xTaskGetTickCount(),
+        .command = {.cmd = CANCEL_WARN}
+    };
+    event_bus_publish_reserved(&cancel);
+}
+
+// Run one event through the state machine; apply and publish any transition
+static void handle_event(alarm_sm *machine, const alert_event *event) {
+    bool from_motion = (event->source == EVENT_SOURCE_MOTION);
+    alarm_event new_event;
+
+    if (from_motion) {
+        new_event = warn_to_alarm_event(event->motion.warning);
+    } else {
+        low_power_mark_event();
+        new_event = command_to_alarm_event(event->command.cmd);
+    }
+
+    alarm_state old_state = alarm_sm_state(machine);
+    alarm_sm_handle_event(machine, new_event);
+    alarm_state new_state = alarm_sm_state(machine);
+    if (new_state == old_state) {
+        return;
+    }
+
+    apply_alerts(new_state);
+    // Let the motion task retune the sensor rate
+    adxl343_motion_notify_state(new_state);
+    low_power_set_state(new_state);
+    // Start warn timeout if entering WARN state
+    if (new_state == WARN) {
+        xTimerStart(warn_timeout_timer, 0);
+    }
+    // Stop warn timeout if leaving WARN state
+    if (old_state == WARN) {
+        xTimerStop(warn_timeout_timer, 0);
+    }
+
+    cloud_update_event update = {0};
+    update.from_motion = from_motion;
+    update.state = new_state;
+    update.timestamp = event->timestamp;
+    update.odr_code = adxl343_motion_odr_code_for_state(new_state);
+    if (from_motion) {
+        update.warning = event->motion.warning;
+        update.device_id = event->motion.device_id;
+    }
+    send_cloud_update(&update);
 }
 
 // Only this task touches LEDs
@@ -96,71 +155,24 @@ void AlertControlTask(void *arg){
     cloud_update_event initial_update = {0};
     initial_update.from_motion = 0;  // Not from motion sensor
     initial_update.state = alarm_machine.state;  // DISARMED
+    initial_update.odr_code = adxl343_motion_odr_code_for_state(alarm_machine.state);
+    adxl343_motion_notify_state(alarm_machine.state);
+    low_power_set_state(alarm_machine.state);
     send_cloud_update(&initial_update);
 
-    // Create queue set for motion and command queues
-    // Receives from both queues and processes whichever has data
-
-    alert_queue_set = xQueueCreateSet(SET_LENGTH);
-    xQueueAddToSet(motion_queue, alert_queue_set);
-    xQueueAddToSet(command_queue, alert_queue_set);
-    
-    warn_timeout_timer = xTimerCreate("WarnTimeout",
-                                      pdMS_TO_TICKS(5000), // 5 second timeout
-                                      pdFALSE,
-                                      NULL,
-                                      warn_timeout_callback);
+    warn_timeout_timer = xTimerCreateStatic("WarnTimeout",
+                                            pdMS_TO_TICKS(5000), // 5 second timeout
+                                            pdFALSE,
+                                            NULL,
+                                            warn_timeout_callback,
+                                            &warn_timeout_timer_buffer);
     
     while (1) {
-        QueueSetMemberHandle_t activated_queue;
-
-        // Take whichever queue has an event
-        activated_queue = xQueueSelectFromSet(alert_queue_set, portMAX_DELAY);
-        
-        // Process the queue based on which one was activated (ready to read)
-        if (activated_queue == motion_queue) {
-            motion_event m_e;
-            xQueueReceive(motion_queue, &m_e, 0);
-            alarm_event new_event = warn_to_alarm_event(m_e.warning);
-            alarm_state old_state = alarm_sm_state(&alarm_machine);
-            alarm_sm_handle_event(&alarm_machine, new_event);
-            alarm_state new_state = alarm_sm_state(&alarm_machine);
-            if (new_state != old_state) {
-                apply_alerts(alarm_machine.state);
-                // Start warn timeout if entering WARN state
-                if (new_state == WARN) {
-                    xTimerStart(warn_timeout_timer, 0);
-                }
-                // Stop warn timeout if leaving WARN state
-                if (old_state == WARN && new_state != WARN) {
-                    xTimerStop(warn_timeout_timer, 0);
-                }
-                cloud_update_event update = {0};
-                update.from_motion = 1;
-                update.warning = m_e.warning;
-                update.state = new_state;
-                send_cloud_update(&update);
-            }
-        }
+        alert_event event;
 
-        if (activated_queue == command_queue) {
-            command_event c_e;
-            xQueueReceive(command_queue, &c_e, 0);
-            alarm_event new_event = command_to_alarm_event(c_e.cmd);
-            alarm_state old_state = alarm_sm_state(&alarm_machine);
-            alarm_sm_handle_event(&alarm_machine, new_event);
-            alarm_state new_state = alarm_sm_state(&alarm_machine);
-            if (new_state != old_state) {
-                apply_alerts(alarm_machine.state);
-                // Stop warn timeout if leaving WARN state
-                if (old_state == WARN && new_state != WARN) {
-                    xTimerStop(warn_timeout_timer, 0);
-                }
-                cloud_update_event update = {0};
-                update.from_motion = 0;
-                update.state = new_state;
-                send_cloud_update(&update);
-            }
+        // Motion and command events arrive in priority order (see event_bus.h)
+        if (event_bus_wait(&event, portMAX_DELAY)) {
+            handle_event(&alarm_machine, &event);
         }
     }
-}
\ No newline at end of file
+}
@@ -8,7 +8,7 @@ int send_cloud_update(cloud_update_event* update);
 
 /* Alert Control Task:
 -> Monitors state machine
--> Processes events from motion and command queues
+-> Processes motion and command events from the event bus
 -> Applies physical alerts
 -> Sends cloud update events
 */
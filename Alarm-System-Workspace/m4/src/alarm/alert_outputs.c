@@ -6,6 +6,12 @@
 
 static volatile LedMode current_mode = OFF;
 
+// Set once LedEffectTask runs; mode changes notify it
+static TaskHandle_t led_task = NULL;
+
+// Period of the animated modes (breathe / flash)
+#define LED_EFFECT_PERIOD_MS 60
+
 static uint8_t breathe_step = 0;
 static uint8_t flash_state = 0;
 
@@ -20,11 +26,18 @@ void alert_outputs_set_mode(LedMode mode) {
     taskENTER_CRITICAL();
     current_mode = mode;
     taskEXIT_CRITICAL();
+
+    // Wake the LED task (it sleeps indefinitely on solid colours)
+    if (led_task != NULL) {
+        xTaskNotifyGive(led_task);
+    }
 }
 
 void LedEffectTask(void *arg) {
     LedMode last_mode = OFF;
 
+    led_task = xTaskGetCurrentTaskHandle();
+
     while (1) {
         // RTOS-safe read of current_mode preventing race
         taskENTER_CRITICAL();
@@ -65,7 +78,7 @@ void LedEffectTask(void *arg) {
             case RED_BREATHE:
                 // Non-blocking breathing effect: advances brightness one step PER LOOP
                 // using precomputed curve -> no delays or waits here, so the task
-                // keeps running and cooperatively yields via vTaskDelay below.
+                // keeps running and cooperatively yields via the notification wait below.
                 set_red_LED_brightness(breathe_curve[breathe_step]);
                 breathe_step = (breathe_step + 1) % breathe_steps;
                 break;
@@ -79,6 +92,13 @@ void LedEffectTask(void *arg) {
                 break;
         }
 
-        vTaskDelay(pdMS_TO_TICKS(60));
+        // Solid colours need no refresh: block until the mode changes so the
+        // system can stay in tickless sleep. Animations step every period,
+        // but a mode change still cuts the wait short.
+        if (mode == RED_BREATHE || mode == RED_FLASH) {
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(LED_EFFECT_PERIOD_MS));
+        } else {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        }
     }
 }
@@ -24,11 +24,14 @@
 #include "board.h"
 #include "uart/uart_coms.h"
 #include "motion/adxl343.h"
+#include "motion/spi_bus.h"
 #include "spi.h"
 #include "mxc_pins.h"
 #include "gpio.h"
 #include "motion/adxl343_motion.h"
 #include "utils/watchdog.h"
+#include "utils/timestamp.h"
+#include "utils/flash_log.h"
 #include "wdt.h"
 #include "utils/queues.h"
 #include "utils/task_handler.h"
@@ -41,8 +44,8 @@
 
 /*
  * System startup sequence:
- * 1. Init queues
- * 2. Init SPI + detect ADXL343
+ * 1. Init queues + timestamp timer
+ * 2. Init SPI bus + detect ADXL343 sensors
  * 3. Init UART
  * 4. Init watchdog
  * 5. Create RTOS tasks
@@ -52,6 +55,7 @@
 
 int main(void) {
     init_queues();
+    timestamp_init();
 
 
     if (MXC_WDT_GetResetFlag(MXC_WDT0)) {
@@ -60,7 +64,6 @@ int main(void) {
 
     int retVal;
     mxc_spi_pins_t spi_pins;
-    int selected_ss = -1;
 
     spi_pins.clock = TRUE;
     spi_pins.miso  = TRUE;
@@ -69,32 +72,23 @@ int main(void) {
     spi_pins.sdio3 = FALSE;
     spi_pins.ss0   = TRUE;
     spi_pins.ss1   = TRUE;
-    spi_pins.ss2   = FALSE;
+    spi_pins.ss2   = TRUE;
 
-    retVal = adxl343_spi_init(&spi_pins);
+    retVal = spi_bus_init(&spi_pins);
     if (retVal != E_NO_ERROR)
         return retVal;
 
-    const int ss_candidates[] = {1, 0};
-    for (unsigned i = 0; i < 2; i++) {
-        adxl343_set_ss(ss_candidates[i]);
-        if (adxl343_probe() == E_NO_ERROR) {
-            selected_ss = ss_candidates[i];
-            break;
-        }
-    }
-
-    if (selected_ss < 0)
+    // Probe every sensor position (lid, base, plinth); need at least one
+    if (adxl343_motion_probe() == 0)
         return -1;
 
-    retVal = adxl343_init();
-    if (retVal != E_NO_ERROR)
-        return retVal;
-
 
     // Initialize UART
     uart_init(on_message_received);
 
+    // Recover any cloud updates left in flash by the last power cycle
+    flash_log_init();
+
     watchdog_init();
     create_all_tasks();
 
@@ -1,4 +1,5 @@
 #include "adxl343.h"
+#include "spi_bus.h"
 #include "mxc_delay.h"
 #include <string.h>
 
@@ -6,104 +7,26 @@
  * ============================================================================
  * ADXL343 SPI Driver (Implementation)
  * ============================================================================
- * This file contains the SPI communication logic and high-level helper
- * functions for configuring and reading data from the ADXL343 accelerometer.
- * It is written to work with the MAX32655 SPI peripheral.
+ * This file contains the register-level logic and high-level helper
+ * functions for configuring and reading data from ADXL343 accelerometers.
+ * Every call takes a device handle; the bytes go through the shared
+ * SPI1 bus owner (spi_bus.c) on that device's slave-select line.
  */
 
 
-/***** SPI config *****/
-static int g_adxl343_ss = 1;
-
-
-/***** SPI transfer helper *****/
-/*
- * Performs a single blocking SPI transaction.
- * This function is the lowest-level SPI routine used by the driver.
- *
- * tx   -> buffer containing bytes to transmit
- * rx   -> buffer where received bytes will be stored
- * len  -> number of bytes to transfer
- */
-static int adxl343_spi_xfer(uint8_t *tx, uint8_t *rx, uint32_t len)
-{
-    // SPI transaction request structure
-    mxc_spi_req_t req = {0};
-
-    // Select SPI peripheral (SPI1)
-    req.spi = SPI;
-
-    // Transmit and receive buffers
-    req.txData = tx;
-    req.rxData = rx;
-
-    // Number of bytes to transmit and receive
-    req.txLen = len;
-    req.rxLen = len;
-
-    // Which slave-select line to use
-    req.ssIdx = g_adxl343_ss;
-
-    // Release slave-select line after transfer completes
-    req.ssDeassert = 1;
-
-    // Transfer counters (managed by driver)
-    req.txCnt = 0;
-    req.rxCnt = 0;
-
-    // Blocking transfer, no callback function
-    req.completeCB = NULL;
-
-    // Execute SPI transaction
-    return MXC_SPI_MasterTransaction(&req);
-}
-
-
-/***** SPI initialization *****/
-/*
- * Initializes the SPI peripheral and configures it for the ADXL343.
- * This must be called before any sensor communication.
- *
- * pins -> structure defining which SPI pins are enabled
- */
-int adxl343_spi_init(const mxc_spi_pins_t *pins)
-{
-    // Count how many slave-select pins are enabled
-    uint32_t num_slaves = pins->ss0 + pins->ss1 + pins->ss2;
-
-    // At least one SS line must be enabled
-    if (num_slaves == 0) {
-        return E_BAD_PARAM;
-    }
-
-    // Initialize SPI in master mode
-    int ret = MXC_SPI_Init(SPI, 1, 0, num_slaves, 0, SPI_SPEED, *pins);
-    if (ret != E_NO_ERROR) return ret;
-
-    // Configure SPI for 8-bit data frames
-    ret = MXC_SPI_SetDataSize(SPI, 8);
-    if (ret != E_NO_ERROR) return ret;
-
-    // Standard single-wire SPI
-    ret = MXC_SPI_SetWidth(SPI, SPI_WIDTH_STANDARD);
-    if (ret != E_NO_ERROR) return ret;
-
-    // SPI Mode 3: CPOL = 1, CPHA = 1 (required by ADXL343)
-    return MXC_SPI_SetMode(SPI, SPI_MODE_3);
-}
-
-
 /***** Register write (multi-byte) *****/
 /*
  * Writes one or more consecutive registers starting at start_reg.
  *
+ * dev       -> target device
  * start_reg -> first register address
  * values    -> pointer to data bytes to write
  * len       -> number of registers to write
  */
-static int adxl343_write_regs(uint8_t start_reg,
-                              const uint8_t *values,
-                              uint32_t len)
+int adxl343_write_regs(const adxl343_dev *dev,
+                       uint8_t start_reg,
+                       const uint8_t *values,
+                       uint32_t len)
 {
     // Total bytes = command byte + data bytes
     uint32_t total = len + 1;
@@ -125,15 +48,16 @@ static int adxl343_write_regs(uint8_t start_reg,
     memcpy(&tx[1], values, len);
 
     // Send SPI transaction
-    return adxl343_spi_xfer(tx, rx, total);
+    return spi_bus_xfer(dev->ss, tx, rx, total);
 }
 
-int adxl343_write_reg(uint8_t reg, uint8_t value)
+int adxl343_write_reg(const adxl343_dev *dev, uint8_t reg, uint8_t value)
 {
-    return adxl343_write_regs(reg, &value, 1);
+    return adxl343_write_regs(dev, reg, &value, 1);
 }
 
-int adxl343_read_regs(uint8_t start_reg, uint8_t *values, uint32_t len)
+int adxl343_read_regs(const adxl343_dev *dev, uint8_t start_reg,
+                      uint8_t *values, uint32_t len)
 {
     // 1 command byte + requested data bytes
     uint32_t total = len + 1;
@@ -151,7 +75,7 @@ int adxl343_read_regs(uint8_t start_reg, uint8_t *values, uint32_t len)
             ((len > 1) ? ADXL343_SPI_MB : 0);
 
     // Perform blocking SPI transaction
-    int ret = adxl343_spi_xfer(tx, rx, total);
+    int ret = spi_bus_xfer(dev->ss, tx, rx, total);
 
     // Copy received register data (skip command byte)
     if (ret == E_NO_ERROR)
@@ -161,17 +85,49 @@ int adxl343_read_regs(uint8_t start_reg, uint8_t *values, uint32_t len)
 }
 
 
+/***** Async register read *****/
+/*
+ * Starts a burst read of len registers without blocking.
+ * buf must hold len + 1 bytes and stay valid until cb runs;
+ * register data lands at buf[1] (buf[0] is clocked in during the command byte).
+ * Passing cb == NULL pairs the read with spi_bus_xfer_wait().
+ * Caller must own the bus.
+ */
+int adxl343_read_regs_async(const adxl343_dev *dev, uint8_t start_reg,
+                            uint8_t *buf, uint32_t len,
+                            spi_bus_cb_t cb, void *ctx)
+{
+    static uint8_t tx[ADXL343_SPI_MAX_TRANSFER];
+
+    if (len + 1 > ADXL343_SPI_MAX_TRANSFER)
+        return E_BAD_PARAM;
+
+    // tx is shared by all async reads - only one can be in flight
+    if (spi_bus_busy())
+        return E_BUSY;
+
+    memset(tx, 0, sizeof(tx));
+    tx[0] = start_reg | ADXL343_SPI_READ |
+            ((len > 1) ? ADXL343_SPI_MB : 0);
+
+    if (cb == NULL)
+        return spi_bus_xfer_start(dev->ss, tx, buf, len + 1);
+
+    return spi_bus_xfer_async(dev->ss, tx, buf, len + 1, cb, ctx);
+}
+
+
 /***** Sensor probe *****/
 /*
  * Confirms that the connected device is an ADXL343 by checking
  * the device ID register.
  */
-int adxl343_probe(void)
+int adxl343_probe(const adxl343_dev *dev)
 {
     uint8_t devid = 0;
 
     // Read device ID register
-    int ret = adxl343_read_regs(ADXL343_REG_DEVID, &devid, 1);
+    int ret = adxl343_read_regs(dev, ADXL343_REG_DEVID, &devid, 1);
     if (ret != E_NO_ERROR) {
         return ret;
     }
@@ -182,12 +138,6 @@ int adxl343_probe(void)
 }
 
 
-/***** Set slave select *****/
-void adxl343_set_ss(int ss) {
-    g_adxl343_ss = ss;
-}
-
-
 /***** Sensor initialization *****/
 /*
  * Fully initializes the ADXL343 sensor:
@@ -196,12 +146,12 @@ void adxl343_set_ss(int ss) {
  *  - Sets output data rate
  *  - Enables measurement mode
  */
-int adxl343_init(void)
+int adxl343_init(const adxl343_dev *dev)
 {
     int ret;
 
     // Confirm sensor is present
-    ret = adxl343_probe();
+    ret = adxl343_probe(dev);
     if (ret != E_NO_ERROR) {
         return ret;
     }
@@ -210,16 +160,147 @@ int adxl343_init(void)
     uint8_t data_format =
         ADXL343_DATA_FULL_RES | ADXL343_DATA_RANGE_2G;
 
-    ret = adxl343_write_reg(ADXL343_REG_DATA_FORMAT, data_format);
+    ret = adxl343_write_reg(dev, ADXL343_REG_DATA_FORMAT, data_format);
     if (ret != E_NO_ERROR) return ret;
 
     // Set output data rate to 100 Hz
-    ret = adxl343_write_reg(ADXL343_REG_BW_RATE, ADXL343_ODR_100_HZ);
+    ret = adxl343_write_reg(dev, ADXL343_REG_BW_RATE, ADXL343_ODR_100_HZ);
     if (ret != E_NO_ERROR) return ret;
 
     // Enable measurement mode
-    return adxl343_write_reg(ADXL343_REG_POWER_CTL,
+    return adxl343_write_reg(dev, ADXL343_REG_POWER_CTL,
                              ADXL343_POWER_MEASURE);
 }
 
 
+/***** Output data rate *****/
+/*
+ * Sets the BW_RATE register (normal power, rate code from the datasheet).
+ * Above 800 Hz the FIFO must be drained in bursts to keep up.
+ */
+int adxl343_set_odr(const adxl343_dev *dev, uint8_t odr)
+{
+    return adxl343_write_reg(dev, ADXL343_REG_BW_RATE, odr);
+}
+
+
+/***** Power mode *****/
+/*
+ * Reprograms BW_RATE (rate + LOW_POWER bit) and POWER_CTL (link,
+ * auto-sleep, measure) together. The datasheet asks for standby before
+ * changing the sleep related bits, so the sequence is:
+ *   POWER_CTL = 0 (standby) -> BW_RATE + POWER_CTL in one burst.
+ * BW_RATE (0x2C) and POWER_CTL (0x2D) are adjacent, so this is two
+ * SPI transactions regardless of the target mode.
+ */
+int adxl343_set_power_mode(const adxl343_dev *dev, uint8_t bw_rate, uint8_t power_ctl)
+{
+    int ret = adxl343_write_reg(dev, ADXL343_REG_POWER_CTL, 0x00);
+    if (ret != E_NO_ERROR) return ret;
+
+    uint8_t regs[2] = { bw_rate, power_ctl };
+    return adxl343_write_regs(dev, ADXL343_REG_BW_RATE, regs, sizeof(regs));
+}
+
+
+/***** FIFO configuration *****/
+/*
+ * Selects the FIFO mode and the watermark level (number of entries
+ * that asserts the WATERMARK interrupt). Samples always trigger on INT1.
+ */
+int adxl343_fifo_config(const adxl343_dev *dev, uint8_t mode, uint8_t watermark)
+{
+    if (watermark == 0 || watermark > ADXL343_FIFO_SAMPLES_MASK) {
+        return E_BAD_PARAM;
+    }
+
+    return adxl343_write_reg(dev, ADXL343_REG_FIFO_CTL,
+                             mode | (watermark & ADXL343_FIFO_SAMPLES_MASK));
+}
+
+
+/***** FIFO drain *****/
+/*
+ * Reads up to max XYZ samples out of the FIFO.
+ *
+ * The number of stored entries is read once from FIFO_STATUS, then each
+ * entry is popped with a single 6-byte burst of DATAX0..DATAZ1 (the
+ * sensor only advances the FIFO at the end of a data register burst,
+ * so one entry per transaction is the fastest legal access).
+ *
+ * From task context the reads are pipelined over DMA: while entry i+1
+ * is being clocked in, entry i is decoded, and the task sleeps between.
+ *
+ * samples -> destination array
+ * max     -> capacity of the destination array
+ * count   -> number of samples actually read
+ */
+static void decode_sample(const uint8_t *raw, adxl343_sample_t *sample)
+{
+    sample->x = (int16_t)(raw[0] | (raw[1] << 8));
+    sample->y = (int16_t)(raw[2] | (raw[3] << 8));
+    sample->z = (int16_t)(raw[4] | (raw[5] << 8));
+}
+
+int adxl343_read_fifo(const adxl343_dev *dev, adxl343_sample_t *samples,
+                      uint32_t max, uint32_t *count)
+{
+    uint8_t status;
+    // Command byte slot + 6 data bytes, double-buffered
+    uint8_t raw[2][7];
+
+    *count = 0;
+
+    int ret = adxl343_read_regs(dev, ADXL343_REG_FIFO_STATUS, &status, 1);
+    if (ret != E_NO_ERROR) return ret;
+
+    uint32_t entries = status & ADXL343_FIFO_ENTRIES_MASK;
+    if (entries > max) entries = max;
+
+    if (!spi_bus_can_block()) {
+        // No task to sleep - plain blocking reads
+        for (uint32_t i = 0; i < entries; i++) {
+            ret = adxl343_read_regs(dev, ADXL343_REG_DATAX0, &raw[0][1], 6);
+            if (ret != E_NO_ERROR) return ret;
+
+            decode_sample(&raw[0][1], &samples[i]);
+            (*count)++;
+
+            // Datasheet: at least 5 us between the end of one data read and
+            // the next FIFO pop so the sensor can move the entry up
+            MXC_Delay(MXC_DELAY_USEC(5));
+        }
+        return E_NO_ERROR;
+    }
+
+    // Hold the bus across the pipelined pops (no-op if the caller owns it)
+    spi_bus_acquire(SPI_BUS_WAIT_FOREVER);
+
+    for (uint32_t i = 0; i < entries; i++) {
+        ret = adxl343_read_regs_async(dev, ADXL343_REG_DATAX0, raw[i & 1], 6,
+                                      NULL, NULL);
+        if (ret != E_NO_ERROR) break;
+
+        // Decode the previous entry while this one is on the wire
+        if (i > 0) {
+            decode_sample(&raw[(i - 1) & 1][1], &samples[i - 1]);
+            (*count)++;
+        }
+
+        ret = spi_bus_xfer_wait();
+        if (ret != E_NO_ERROR) break;
+
+        MXC_Delay(MXC_DELAY_USEC(5));
+    }
+
+    spi_bus_release();
+
+    if (ret != E_NO_ERROR) return ret;
+
+    if (entries > 0) {
+        decode_sample(&raw[(entries - 1) & 1][1], &samples[entries - 1]);
+        (*count)++;
+    }
+
+    return E_NO_ERROR;
+}
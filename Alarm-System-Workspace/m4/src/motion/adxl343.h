@@ -4,11 +4,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "mxc_device.h"
-#include "spi.h"
-
-#define SPI_SPEED 1000000
-
-#define SPI MXC_SPI1
+#include "spi_bus.h"
 
 // ADXL343 register map (see adxl343 datasheet)
 #define ADXL343_REG_DEVID 0x00
@@ -16,25 +12,72 @@
 #define ADXL343_REG_POWER_CTL 0x2D
 #define ADXL343_REG_DATA_FORMAT 0x31
 #define ADXL343_REG_DATAX0 0x32
+#define ADXL343_REG_FIFO_CTL 0x38
+#define ADXL343_REG_FIFO_STATUS 0x39
 
 #define ADXL343_DEVID_VALUE 0xE5
+#define ADXL343_ODR_12_5_HZ 0x07
 #define ADXL343_ODR_100_HZ 0x0A
+#define ADXL343_ODR_800_HZ 0x0D
+#define ADXL343_ODR_1600_HZ 0x0E
+#define ADXL343_ODR_3200_HZ 0x0F
+#define ADXL343_BW_LOW_POWER (1 << 4) // Valid for 12.5..400 Hz
+#define ADXL343_ODR_CODE_MASK 0x0F
+#define ADXL343_POWER_LINK (1 << 5)
+#define ADXL343_POWER_AUTO_SLEEP (1 << 4)
 #define ADXL343_POWER_MEASURE (1 << 3)
+#define ADXL343_POWER_WAKEUP_8_HZ 0x00
 #define ADXL343_DATA_FULL_RES (1 << 3)
 #define ADXL343_DATA_RANGE_2G 0x00
 
+// FIFO_CTL modes (bits 7:6) and FIFO_STATUS entry count (bits 5:0)
+#define ADXL343_FIFO_BYPASS 0x00
+#define ADXL343_FIFO_MODE 0x40
+#define ADXL343_FIFO_STREAM 0x80
+#define ADXL343_FIFO_TRIGGER 0xC0
+#define ADXL343_FIFO_SAMPLES_MASK 0x1F
+#define ADXL343_FIFO_ENTRIES_MASK 0x3F
+#define ADXL343_FIFO_DEPTH 32
+
 #define ADXL343_SPI_READ 0x80
 #define ADXL343_SPI_MB 0x40
-#define ADXL343_SPI_SS_INDEX 1 // Use SS1 on the Feather header by default
-#define ADXL343_SPI_MAX_TRANSFER 8 // Command byte + 6 data bytes, rounded up
+#define ADXL343_SPI_MAX_TRANSFER 16 // Command byte + longest register burst, rounded up
+
+// One XYZ sample as stored in DATAX0..DATAZ1 (little-endian, full resolution)
+typedef struct adxl343_sample {
+    int16_t x;
+    int16_t y;
+    int16_t z;
+} adxl343_sample_t;
+
+/*
+ * Device handle: one per physical sensor on the shared SPI1 bus.
+ * id is the index reported upstream (cloud updates carry it).
+ */
+typedef struct adxl343_dev {
+    uint8_t id;
+    int ss;      // SPI1 slave-select index
+} adxl343_dev;
+
+int adxl343_probe(const adxl343_dev *dev);
+int adxl343_init(const adxl343_dev *dev);
+
+int adxl343_write_reg(const adxl343_dev *dev, uint8_t reg, uint8_t value);
+int adxl343_write_regs(const adxl343_dev *dev, uint8_t start_reg,
+                       const uint8_t *values, uint32_t len);
+int adxl343_read_regs(const adxl343_dev *dev, uint8_t start_reg,
+                      uint8_t *values, uint32_t len);
 
-int adxl343_spi_init(const mxc_spi_pins_t *pins);
-int adxl343_probe(void);
-int adxl343_init(void);
-void adxl343_set_ss(int ss);
+// Non-blocking DMA register read (caller owns the bus, see spi_bus.h)
+int adxl343_read_regs_async(const adxl343_dev *dev, uint8_t start_reg,
+                            uint8_t *buf, uint32_t len,
+                            spi_bus_cb_t cb, void *ctx);
 
-int adxl343_write_reg(uint8_t reg, uint8_t value);
-int adxl343_read_regs(uint8_t start_reg, uint8_t *values, uint32_t len);
+int adxl343_set_odr(const adxl343_dev *dev, uint8_t odr);
+int adxl343_set_power_mode(const adxl343_dev *dev, uint8_t bw_rate, uint8_t power_ctl);
+int adxl343_fifo_config(const adxl343_dev *dev, uint8_t mode, uint8_t watermark);
+int adxl343_read_fifo(const adxl343_dev *dev, adxl343_sample_t *samples,
+                      uint32_t max, uint32_t *count);
 
 
 #endif // ADXL343_H
@@ -1,33 +1,138 @@
 #include "adxl343_motion.h"
 #include "adxl343.h"
+#include "spi_bus.h"
+#include "motion_dsp.h"
+#include "vibration_classifier.h"
 #include "gpio.h"
 #include "mxc_device.h"
 #include "board.h"
 
 #include "FreeRTOS.h"
 #include "task.h"
-#include "semphr.h"
+#include "timers.h"
 #include "../utils/typing.h"
+#include "../utils/timestamp.h"
+#include "../utils/low_power.h"
+#include "../utils/spsc_ring.h"
+#include "../utils/task_signal.h"
 #include "queues.h"
+#include "event_bus.h"
+#include <string.h>
 
 /*
- * This module handles motion detection using the ADXL343 accelerometer.
- * Hardware interrupts from the sensor are converted into RTOS events
+ * This module handles motion detection using up to MOTION_MAX_SENSORS
+ * ADXL343 accelerometers sharing SPI1 (one slave-select line each).
+ * Hardware interrupts from the sensors are converted into RTOS events
  * that higher-level system logic can react to.
  
  * Flow:
- * ADXL343 interrupt → GPIO ISR → semaphore → MotionDetectionTask →
- * prioritised motion event sent to system queue
+ * ADXL343 interrupt → GPIO ISR (per sensor, timestamp only) → task notification →
+ * MotionDetectionTask (per sensor: INT_SOURCE read, FIFO drain, shake DSP,
+ * vibration classifier) → fused tamper decision →
+ * prioritised motion event (with source device) published to the event bus
  */
 
 
+/***** Sensor placement *****/
+/*
+ * One entry per possible sensor in the case. Sensors that do not answer
+ * the probe are skipped. All INT1 lines sit on GPIO port 1 so a single
+ * NVIC handler serves every sensor - adjust pins to the case wiring.
+ */
+#define MOTION_INT_PORT MXC_GPIO1
+
+typedef struct sensor_placement {
+    const char *name;
+    int ss;            // SPI1 slave-select index
+    uint32_t int_pin;  // INT1 pin on MOTION_INT_PORT
+} sensor_placement;
+
+static const sensor_placement placements[MOTION_MAX_SENSORS] = {
+    { "lid",    1, 8 },
+    { "base",   0, 9 },
+    { "plinth", 2, 7 },
+};
+
+
 /***** Activity rate limiting *****/
 /*
  * Activity interrupts can trigger continuously while movement persists.
  * This cooldown limits how often activity events are forwarded.
+ *
+ * Once an ACTIVITY interrupt is taken, ACTIVITY is masked in INT_ENABLE
+ * for the cooldown window, so persistent movement no longer costs an
+ * ISR + SPI read + task wake-up per edge. A one-shot timer re-arms it.
+ * Free-fall, double-tap and the FIFO interrupts stay enabled throughout.
  */
 #define ACTIVITY_COOLDOWN_MS 2000
-static TickType_t last_activity_tick = 0;
+
+
+/***** Tamper fusion *****/
+/*
+ * Every sensor yields at most one candidate warning per task pass.
+ * The fused decision is the most severe candidate and names its sensor
+ * as the source. A LOW candidate is raised to MED when another sensor
+ * also saw movement within FUSION_WINDOW_MS: the case is being moved as
+ * a whole rather than one panel being brushed.
+ */
+#define FUSION_WINDOW_MS 1000
+
+
+/***** Sample streaming *****/
+/*
+ * In streaming mode the FIFO runs in stream mode and only raises a
+ * WATERMARK interrupt once MOTION_FIFO_WATERMARK samples are queued.
+ * The task then drains the whole FIFO in one go, so high output data
+ * rates cost one interrupt per block instead of one per sample.
+ */
+#define MOTION_STREAM_ENABLE   1
+#define MOTION_FIFO_WATERMARK  16
+
+// Must be a power of two (index wrap uses a mask)
+#define MOTION_SAMPLE_RING_SIZE 128
+
+
+/***** State-aware power modes *****/
+/*
+ * The sensor rate follows the alarm state published by AlertControlTask.
+ * DISARMED / ARMED_IDLE run in low-power mode with link + auto-sleep, so
+ * the part drops to its 8 Hz sleep rate when nothing moves. Any warning
+ * state switches to full-rate, normal-power sampling for the shake DSP.
+ *
+ * The sleepy modes do not stream: with the FIFO interrupts off the MCU
+ * only wakes for motion events. A fresh ACTIVITY turns streaming on for
+ * the activity cooldown window, so the shake DSP and the vibration
+ * classifier still see the movement (and the FIFO's last 32 samples
+ * before it).
+ */
+typedef struct power_mode {
+    uint8_t bw_rate;     // ODR code | LOW_POWER
+    uint8_t power_ctl;   // LINK | AUTO_SLEEP | MEASURE | wakeup rate
+    uint16_t odr_hz;
+    bool stream;         // FIFO WATERMARK/OVERRUN enabled all the time
+} power_mode;
+
+#define POWER_CTL_SLEEPY (ADXL343_POWER_LINK | ADXL343_POWER_AUTO_SLEEP | \
+                          ADXL343_POWER_MEASURE | ADXL343_POWER_WAKEUP_8_HZ)
+
+static const power_mode power_modes[] = {
+    [DISARMED]   = { ADXL343_ODR_12_5_HZ | ADXL343_BW_LOW_POWER, POWER_CTL_SLEEPY, 12, false },
+    [ARMED_IDLE] = { ADXL343_ODR_100_HZ | ADXL343_BW_LOW_POWER,  POWER_CTL_SLEEPY, 100, false },
+    [WARN]       = { ADXL343_ODR_800_HZ, ADXL343_POWER_MEASURE, 800, true },
+    [ALERT]      = { ADXL343_ODR_800_HZ, ADXL343_POWER_MEASURE, 800, true },
+    [ALARM]      = { ADXL343_ODR_800_HZ, ADXL343_POWER_MEASURE, 800, true },
+};
+#define POWER_MODE_COUNT (sizeof(power_modes) / sizeof(power_modes[0]))
+
+/*
+ * Requested state (written by AlertControlTask) and the one applied.
+ * Latency runs from the request to the end of the register writes.
+ */
+static volatile alarm_state requested_state = DISARMED;
+static volatile uint32_t state_request_ts = 0;
+static alarm_state applied_state = DISARMED;
+static uint16_t current_odr_hz = 12;
+static motion_power_stats power_stats;
 
 
 /***** ADXL343 registers (motion related) *****/
@@ -36,6 +141,9 @@ static TickType_t last_activity_tick = 0;
  * These are used to configure tap, activity, inactivity and free-fall.
  */
 #define ADXL343_THRESH_TAP     0x1D
+#define ADXL343_OFSX           0x1E
+#define ADXL343_OFSY           0x1F
+#define ADXL343_OFSZ           0x20
 #define ADXL343_DUR            0x21
 #define ADXL343_LATENT         0x22
 #define ADXL343_WINDOW         0x23
@@ -54,6 +162,80 @@ static TickType_t last_activity_tick = 0;
 #define ADXL343_INT_SOURCE     0x30
 
 
+/***** Sensor profiles *****/
+/*
+ * The whole tap / offset / activity / free-fall block is contiguous
+ * (0x1D..0x2A), so a profile is one 14-byte image of it. It is written
+ * with a single multi-byte SPI transaction and verified with a single
+ * burst read. INT_MAP / INT_ENABLE are not part of a profile.
+ */
+#define PROFILE_FIRST_REG  ADXL343_THRESH_TAP
+#define PROFILE_LAST_REG   ADXL343_TAP_AXES
+#define PROFILE_LEN        (PROFILE_LAST_REG - PROFILE_FIRST_REG + 1)
+#define PROFILE_REG(r)     [(r) - PROFILE_FIRST_REG]
+
+typedef struct sensor_profile {
+    const char *name;
+    uint8_t regs[PROFILE_LEN];
+} sensor_profile;
+
+static const sensor_profile profiles[MOTION_PROFILE_COUNT] = {
+    // Quiet gallery: sensitive tap and activity detection
+    [MOTION_PROFILE_MUSEUM_QUIET] = {
+        .name = "museum-quiet",
+        .regs = {
+            PROFILE_REG(ADXL343_THRESH_TAP)    = 30,
+            PROFILE_REG(ADXL343_DUR)           = 20,
+            PROFILE_REG(ADXL343_LATENT)        = 40,
+            PROFILE_REG(ADXL343_WINDOW)        = 100,
+            PROFILE_REG(ADXL343_THRESH_ACT)    = 60,
+            PROFILE_REG(ADXL343_THRESH_INACT)  = 20,
+            PROFILE_REG(ADXL343_TIME_INACT)    = 50,
+            PROFILE_REG(ADXL343_ACT_INACT_CTL) = 0x70, // DC-coupled, X/Y/Z
+            PROFILE_REG(ADXL343_THRESH_FF)     = 9,
+            PROFILE_REG(ADXL343_TIME_FF)       = 20,
+            PROFILE_REG(ADXL343_TAP_AXES)      = 0x07, // X, Y, Z
+        }
+    },
+    // Busy hall: footfall and doors shake the plinth, raise thresholds
+    [MOTION_PROFILE_HIGH_TRAFFIC] = {
+        .name = "high-traffic",
+        .regs = {
+            PROFILE_REG(ADXL343_THRESH_TAP)    = 56,
+            PROFILE_REG(ADXL343_DUR)           = 16,
+            PROFILE_REG(ADXL343_LATENT)        = 40,
+            PROFILE_REG(ADXL343_WINDOW)        = 100,
+            PROFILE_REG(ADXL343_THRESH_ACT)    = 110,
+            PROFILE_REG(ADXL343_THRESH_INACT)  = 40,
+            PROFILE_REG(ADXL343_TIME_INACT)    = 50,
+            PROFILE_REG(ADXL343_ACT_INACT_CTL) = 0xF0, // AC-coupled, X/Y/Z
+            PROFILE_REG(ADXL343_THRESH_FF)     = 9,
+            PROFILE_REG(ADXL343_TIME_FF)       = 20,
+            PROFILE_REG(ADXL343_TAP_AXES)      = 0x07,
+        }
+    },
+    // Crated for transport: ignore handling, keep drops and hard knocks
+    [MOTION_PROFILE_TRANSPORT] = {
+        .name = "transport",
+        .regs = {
+            PROFILE_REG(ADXL343_THRESH_TAP)    = 96,
+            PROFILE_REG(ADXL343_DUR)           = 16,
+            PROFILE_REG(ADXL343_LATENT)        = 40,
+            PROFILE_REG(ADXL343_WINDOW)        = 100,
+            PROFILE_REG(ADXL343_THRESH_ACT)    = 180,
+            PROFILE_REG(ADXL343_THRESH_INACT)  = 60,
+            PROFILE_REG(ADXL343_TIME_INACT)    = 30,
+            PROFILE_REG(ADXL343_ACT_INACT_CTL) = 0xF0,
+            PROFILE_REG(ADXL343_THRESH_FF)     = 7,
+            PROFILE_REG(ADXL343_TIME_FF)       = 25,
+            PROFILE_REG(ADXL343_TAP_AXES)      = 0x07,
+        }
+    },
+};
+
+#define MOTION_DEFAULT_PROFILE MOTION_PROFILE_MUSEUM_QUIET
+
+
 /***** Interrupt source bits *****/
 /*
  * Bit masks used to interpret the ADXL343 INT_SOURCE register.
@@ -62,55 +244,518 @@ static TickType_t last_activity_tick = 0;
 #define ADXL343_INT_DOUBLE_TAP (1 << 5)
 #define ADXL343_INT_ACTIVITY   (1 << 4)
 #define ADXL343_INT_FREE_FALL  (1 << 2)
+#define ADXL343_INT_WATERMARK  (1 << 1)
+#define ADXL343_INT_OVERRUN    (1 << 0)
 
+#define ADXL343_INT_MOTION (ADXL343_INT_DOUBLE_TAP | ADXL343_INT_ACTIVITY | \
+                            ADXL343_INT_FREE_FALL)
 
-/***** GPIO mapping *****/
+
+/* ---------- RTOS objects ---------- */
 /*
- * GPIO pin connected to the ADXL343 interrupt output.
- * The sensor asserts this pin when an enabled interrupt occurs.
+ * motion_task -> woken with TASK_SIGNAL_MOTION_* bits (task_signal.h):
+ *                edge, profile, state change and per-sensor re-arm
+ * edge_ring   -> edge captures from the GPIO ISR (single producer: every
+ *                sensor pin is on GPIO1) to the motion task
  */
-#define ADXL343_INT_PORT MXC_GPIO1
-#define ADXL343_INT_PIN  8
+static TaskHandle_t motion_task = NULL;
 
+#define MOTION_SIGNALS (TASK_SIGNAL_MOTION_EDGE | TASK_SIGNAL_MOTION_PROFILE | \
+                        TASK_SIGNAL_MOTION_STATE | TASK_SIGNAL_MOTION_REARM_ALL)
+
+#define MOTION_EDGE_RING_SIZE 16  // Power of two
 
-/* ---------- RTOS objects ---------- */
 /*
- * motionSem   -> binary semaphore used to wake the motion task from ISR
+ * INT1 is edge-triggered but the ADXL343 sources stay latched: while any
+ * enabled source is set the line stays high and no new edge arrives.
+ * service_sensor re-reads INT_SOURCE until nothing enabled is left, at
+ * most this many times; if the line is still high after that the sensor
+ * is queued for another round.
  */
-static SemaphoreHandle_t motionSem;
+#define MOTION_SERVICE_PASSES 4
+
+typedef struct motion_edge {
+    uint8_t device;
+    uint32_t ts;          // TMR count at the edge
+    TickType_t tick;      // RTOS tick at the edge
+} motion_edge;
+
+static motion_edge edge_storage[MOTION_EDGE_RING_SIZE];
+static spsc_ring edge_ring;
+
+// Bit per device whose edge did not fit in edge_ring. INT1 is
+// edge-triggered, so the sensor must still be serviced: set by the ISR,
+// taken by the task in a critical section.
+static volatile uint32_t edge_overflow = 0;
+
+
+/* ---------- Per-sensor state ---------- */
+typedef struct motion_sensor {
+    adxl343_dev dev;
+    const sensor_placement *place;
+    bool present;
+
+    /*
+     * Oldest edge taken off edge_ring and not yet serviced (task only).
+     * Later edges for the same sensor are coalesced into it: that is the
+     * oldest pending event and the one whose latency matters.
+     */
+    bool capture_pending;
+    uint32_t capture_ts;
+    TickType_t capture_tick;
+    motion_irq_stats irq_stats;
+
+    // INT_ENABLE shadow (ACTIVITY drops out during a cooldown window)
+    uint8_t int_enable_mask;
+    TickType_t last_activity_tick;
+    TimerHandle_t activity_rearm_timer;
+    StaticTimer_t activity_rearm_timer_buffer;
+    motion_activity_stats activity_stats;
 
+    // Last time this sensor saw any movement (for fusion)
+    bool motion_seen;
+    TickType_t last_motion_tick;
+
+    /*
+     * Sample ring buffer filled by the FIFO drain.
+     * Only MotionDetectionTask writes it; readers call adxl343_motion_read_samples.
+     * When full, the oldest samples are overwritten and counted as dropped.
+     */
+    adxl343_sample_t sample_ring[MOTION_SAMPLE_RING_SIZE];
+    uint32_t sample_head;
+    uint32_t sample_tail;
+    motion_stream_stats stream_stats;
+
+    /*
+     * Shake pipeline state. Severity is reported on a rising edge only:
+     * a sustained shake produces one event per level, not one per block.
+     */
+    motion_dsp shake_dsp;
+    shake_severity reported_shake;
+
+    /*
+     * Spectral classifier fed with the same high-passed blocks.
+     * While it reports BACKGROUND, low and medium confidence events
+     * (activity, low/medium shake) are held back from the event bus.
+     */
+    vib_classifier vib;
+} motion_sensor;
+
+static motion_sensor sensors[MOTION_MAX_SENSORS];
+static motion_fusion_stats fusion_stats;
 
-/* ---------- Module state ---------- */
 /*
- * motion_flags accumulates interrupt source bits read from the sensor.
- * Marked volatile because it is written in ISR context and read in task context.
+ * Profile switch requested over UART (from the UART link task).
+ * The task applies it when it sees TASK_SIGNAL_MOTION_PROFILE.
  */
-static volatile uint8_t motion_flags = 0;
+static volatile motion_profile profile_request;
+static motion_profile active_profile = MOTION_DEFAULT_PROFILE;
+
+// Iterate over the sensors that answered the probe
+#define FOR_EACH_SENSOR(s) \
+    for (motion_sensor *s = sensors; s < &sensors[MOTION_MAX_SENSORS]; s++) \
+        if (s->present)
+
+
+static motion_sensor *sensor_by_id(uint8_t device)
+{
+    if (device >= MOTION_MAX_SENSORS || !sensors[device].present)
+        return NULL;
+    return &sensors[device];
+}
+
+
+/***** Sample ring helpers *****/
+static void sample_ring_push(motion_sensor *s, const adxl343_sample_t *samples, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        if (s->sample_head - s->sample_tail == MOTION_SAMPLE_RING_SIZE) {
+            // Ring full - overwrite oldest sample
+            s->sample_tail++;
+            s->stream_stats.samples_dropped++;
+        }
+        s->sample_ring[s->sample_head & (MOTION_SAMPLE_RING_SIZE - 1)] = samples[i];
+        s->sample_head++;
+    }
+}
+
+static uint32_t sample_ring_pop(motion_sensor *s, adxl343_sample_t *out, uint32_t max)
+{
+    uint32_t n = 0;
+
+    while (n < max && s->sample_tail != s->sample_head) {
+        out[n++] = s->sample_ring[s->sample_tail & (MOTION_SAMPLE_RING_SIZE - 1)];
+        s->sample_tail++;
+    }
+
+    return n;
+}
+
+static uint32_t sample_ring_count(const motion_sensor *s)
+{
+    return s->sample_head - s->sample_tail;
+}
+
+int adxl343_motion_read_samples(uint8_t device, adxl343_sample_t *out, uint32_t max)
+{
+    motion_sensor *s = sensor_by_id(device);
+    if (!s)
+        return -1;
+
+    return (int)sample_ring_pop(s, out, max);
+}
+
+
+/***** Statistics *****/
+int adxl343_motion_get_stream_stats(uint8_t device, motion_stream_stats *stats)
+{
+    motion_sensor *s = sensor_by_id(device);
+    if (!s)
+        return -1;
+
+    *stats = s->stream_stats;
+    return 0;
+}
+
+int adxl343_motion_get_irq_stats(uint8_t device, motion_irq_stats *stats)
+{
+    motion_sensor *s = sensor_by_id(device);
+    if (!s)
+        return -1;
+
+    taskENTER_CRITICAL();
+    *stats = s->irq_stats;
+    taskEXIT_CRITICAL();
+    return 0;
+}
+
+int adxl343_motion_get_dsp_stats(uint8_t device, motion_dsp_stats *stats)
+{
+    motion_sensor *s = sensor_by_id(device);
+    if (!s)
+        return -1;
+
+    *stats = s->shake_dsp.stats;
+    return 0;
+}
+
+int adxl343_motion_get_vib_stats(uint8_t device, vib_stats *stats)
+{
+    motion_sensor *s = sensor_by_id(device);
+    if (!s)
+        return -1;
+
+    *stats = s->vib.stats;
+    return 0;
+}
+
+int adxl343_motion_get_activity_stats(uint8_t device, motion_activity_stats *stats)
+{
+    motion_sensor *s = sensor_by_id(device);
+    if (!s)
+        return -1;
+
+    *stats = s->activity_stats;
+    return 0;
+}
+
+void adxl343_motion_get_fusion_stats(motion_fusion_stats *stats)
+{
+    *stats = fusion_stats;
+}
+
+uint8_t adxl343_motion_sensor_count(void)
+{
+    uint8_t n = 0;
+    FOR_EACH_SENSOR(s)
+        n++;
+    return n;
+}
+
+const char *adxl343_motion_sensor_name(uint8_t device)
+{
+    return (device < MOTION_MAX_SENSORS) ? placements[device].name : "unknown";
+}
+
+
+/***** FIFO drain *****/
+/*
+ * Empties the sensor FIFO into the sample ring.
+ * Draining every entry also drops the FIFO below the watermark,
+ * which de-asserts the interrupt line for the next edge.
+ */
+static void drain_fifo(motion_sensor *s)
+{
+    adxl343_sample_t batch[ADXL343_FIFO_DEPTH];
+    uint32_t count = 0;
+
+    if (adxl343_read_fifo(&s->dev, batch, ADXL343_FIFO_DEPTH, &count) != E_NO_ERROR) {
+        s->stream_stats.read_errors++;
+    }
+
+    sample_ring_push(s, batch, count);
+    s->stream_stats.samples_read += count;
+    s->stream_stats.blocks_read++;
+}
+
+
+/***** Shake pipeline *****/
+/*
+ * Runs every complete block in the sample ring through the DSP pipeline.
+ * Returns the highest newly reached severity, or SHAKE_NONE if the
+ * severity did not rise since it was last reported.
+ */
+static shake_severity process_sample_blocks(motion_sensor *s)
+{
+    adxl343_sample_t block[MOTION_DSP_BLOCK_SIZE];
+    q15_t hp_axes[3][MOTION_DSP_BLOCK_SIZE];
+    shake_severity rising = SHAKE_NONE;
+
+    while (sample_ring_count(s) >= MOTION_DSP_BLOCK_SIZE) {
+        sample_ring_pop(s, block, MOTION_DSP_BLOCK_SIZE);
+
+        shake_severity level = motion_dsp_process_block(&s->shake_dsp, block, hp_axes);
+        vib_classifier_push(&s->vib, hp_axes, current_odr_hz);
+
+        if (level > s->reported_shake) {
+            s->reported_shake = level;
+            if (level > rising)
+                rising = level;
+        } else if (level == SHAKE_NONE) {
+            // Shake over - re-arm reporting from the bottom
+            s->reported_shake = SHAKE_NONE;
+        }
+    }
+
+    return rising;
+}
+
+
+/***** Profile programming *****/
+/*
+ * Writes the profile image in one burst and reads it back in one burst.
+ * Interrupts are masked while the thresholds change so a half-written
+ * profile cannot raise events. Caller must own the bus.
+ */
+static int apply_profile(motion_sensor *s, motion_profile id)
+{
+    uint8_t readback[PROFILE_LEN];
+    int ret;
+
+    if (id >= MOTION_PROFILE_COUNT)
+        return E_BAD_PARAM;
+
+    const sensor_profile *p = &profiles[id];
+
+    ret = adxl343_write_reg(&s->dev, ADXL343_INT_ENABLE, 0x00);
+    if (ret != E_NO_ERROR)
+        return ret;
+
+    ret = adxl343_write_regs(&s->dev, PROFILE_FIRST_REG, p->regs, PROFILE_LEN);
+    if (ret == E_NO_ERROR)
+        ret = adxl343_read_regs(&s->dev, PROFILE_FIRST_REG, readback, PROFILE_LEN);
+    if (ret == E_NO_ERROR && memcmp(readback, p->regs, PROFILE_LEN) != 0)
+        ret = E_BAD_STATE;
+
+    // Restore interrupts even if verification failed
+    int en = adxl343_write_reg(&s->dev, ADXL343_INT_ENABLE, s->int_enable_mask);
+    if (ret == E_NO_ERROR)
+        ret = en;
+
+    return ret;
+}
+
+// Programs every sensor; the profile only counts as active if all took it
+static int apply_profile_all(motion_profile id)
+{
+    int ret = E_NO_ERROR;
+
+    spi_bus_acquire(SPI_BUS_WAIT_FOREVER);
+    FOR_EACH_SENSOR(s) {
+        int r = apply_profile(s, id);
+        if (r != E_NO_ERROR)
+            ret = r;
+    }
+    spi_bus_release();
+
+    if (ret == E_NO_ERROR)
+        active_profile = id;
+
+    return ret;
+}
+
+/*
+ * Called from the UART link task: records the request and wakes the task.
+ */
+void adxl343_motion_request_profile(motion_profile id)
+{
+    if (id >= MOTION_PROFILE_COUNT || motion_task == NULL)
+        return;
+
+    profile_request = id;
+    task_signal_raise(motion_task, TASK_SIGNAL_MOTION_PROFILE);
+}
+
+motion_profile adxl343_motion_get_profile(void)
+{
+    return active_profile;
+}
+
+const char *adxl343_motion_profile_name(motion_profile id)
+{
+    return (id < MOTION_PROFILE_COUNT) ? profiles[id].name : "unknown";
+}
+
+
+/***** Power mode switching *****/
+/*
+ * Turns the FIFO interrupts on or off (no-op without MOTION_STREAM_ENABLE).
+ * Samples left from before a gap would be glued onto the new ones, so a
+ * half-collected DSP block and FFT window are dropped when it starts.
+ * Caller must own the bus.
+ */
+static void set_streaming(motion_sensor *s, bool on)
+{
+#if MOTION_STREAM_ENABLE
+    const uint8_t fifo_ints = ADXL343_INT_WATERMARK | ADXL343_INT_OVERRUN;
+    bool streaming = (s->int_enable_mask & fifo_ints) != 0;
+
+    if (on == streaming)
+        return;
+
+    if (on) {
+        s->int_enable_mask |= fifo_ints;
+        s->sample_tail = s->sample_head;
+        s->vib.fill = 0;
+    } else {
+        s->int_enable_mask &= ~fifo_ints;
+    }
+    adxl343_write_reg(&s->dev, ADXL343_INT_ENABLE, s->int_enable_mask);
+#else
+    (void)s;
+    (void)on;
+#endif
+}
+
+static const power_mode *power_mode_for_state(alarm_state state)
+{
+    return &power_modes[(state < POWER_MODE_COUNT) ? state : ARMED_IDLE];
+}
+
+// Reprograms every sensor for the given state
+static int apply_power_mode(alarm_state state)
+{
+    const power_mode *m = power_mode_for_state(state);
+    int ret = E_NO_ERROR;
+
+    spi_bus_acquire(SPI_BUS_WAIT_FOREVER);
+    FOR_EACH_SENSOR(s) {
+        int r = adxl343_set_power_mode(&s->dev, m->bw_rate, m->power_ctl);
+        if (r != E_NO_ERROR)
+            ret = r;
+
+        // Leaving a warning state mid-burst also ends the burst
+        set_streaming(s, m->stream);
+
+        if (m->odr_hz != current_odr_hz) {
+            // Samples in a half-collected FFT window were taken at the old rate
+            s->vib.fill = 0;
+        }
+    }
+    spi_bus_release();
+
+    current_odr_hz = m->odr_hz;
+    applied_state = state;
+
+    return ret;
+}
+
+/*
+ * Called by AlertControlTask on every state change (task context).
+ * The motion task reprograms the sensors before it handles any more
+ * sensor events, so the switch costs one wake-up plus two SPI
+ * transactions per sensor.
+ */
+void adxl343_motion_notify_state(alarm_state state)
+{
+    taskENTER_CRITICAL();
+    requested_state = state;
+    state_request_ts = timestamp_now();
+    taskEXIT_CRITICAL();
+
+    task_signal_raise(motion_task, TASK_SIGNAL_MOTION_STATE);
+}
+
+uint8_t adxl343_motion_odr_code_for_state(alarm_state state)
+{
+    return power_mode_for_state(state)->bw_rate & ADXL343_ODR_CODE_MASK;
+}
+
+void adxl343_motion_get_power_stats(motion_power_stats *stats)
+{
+    taskENTER_CRITICAL();
+    *stats = power_stats;
+    taskEXIT_CRITICAL();
+}
+
+
+/***** Activity masking *****/
+/*
+ * Timer service task context: only flags the re-arm and wakes the
+ * motion task, which owns the bus.
+ */
+static void activity_rearm_callback(TimerHandle_t timer)
+{
+    motion_sensor *s = pvTimerGetTimerID(timer);
+
+    task_signal_raise(motion_task, TASK_SIGNAL_MOTION_REARM(s - sensors));
+}
+
+// Caller must own the bus
+static void activity_mask(motion_sensor *s)
+{
+    s->int_enable_mask &= ~ADXL343_INT_ACTIVITY;
+    adxl343_write_reg(&s->dev, ADXL343_INT_ENABLE, s->int_enable_mask);
+    s->activity_stats.mask_windows++;
+
+    // SHAKE_LOW cooldown runs alongside the mask window
+    s->last_activity_tick = xTaskGetTickCount();
+    xTimerStart(s->activity_rearm_timer, 0);
+}
+
+static void activity_unmask(motion_sensor *s)
+{
+    s->int_enable_mask |= ADXL343_INT_ACTIVITY;
+    adxl343_write_reg(&s->dev, ADXL343_INT_ENABLE, s->int_enable_mask);
+}
 
 
 /***** GPIO ISR callback *****/
 /*
- * This callback runs in interrupt context.
- * It should be fast and perform minimal work:
- *  - read interrupt source from sensor
- *  - store flags
- *  - wake motion task via semaphore
+ * This callback runs in interrupt context, once per sensor INT line.
+ * It does a fixed, tiny amount of work and never touches the SPI bus:
+ *  - timestamp the edge with the hardware timer
+ *  - push the capture onto edge_ring (lock-free); if full, flag the sensor
+ *    in edge_overflow so it is still serviced
+ *  - wake motion task with TASK_SIGNAL_MOTION_EDGE
+ * INT_SOURCE is read (and cleared) by the task.
  */
 static void gpio_irq_handler(void *cbdata)
 {
+    motion_sensor *s = cbdata;
     BaseType_t woken = pdFALSE;
-    uint8_t src;
-
-    (void)cbdata;
-
-    // Reading INT_SOURCE clears the interrupt inside the ADXL343
-    adxl343_read_regs(ADXL343_INT_SOURCE, &src, 1);
 
-    // Accumulate interrupt flags (may receive multiple events)
-    motion_flags |= src;
+    motion_edge edge = {
+        .device = s->dev.id,
+        .ts = timestamp_now(),
+        .tick = xTaskGetTickCountFromISR()
+    };
+    if (!spsc_ring_push(&edge_ring, &edge))
+        edge_overflow |= 1u << s->dev.id;
+    s->irq_stats.irq_count++;
 
     // Wake motion detection task
-    xSemaphoreGiveFromISR(motionSem, &woken);
+    task_signal_raise_from_isr(motion_task, TASK_SIGNAL_MOTION_EDGE, &woken);
 
     // Request context switch if needed
     portYIELD_FROM_ISR(woken);
@@ -121,7 +766,7 @@ static void gpio_irq_handler(void *cbdata)
 /*
  * NVIC interrupt handler for GPIO1.
  * Delegates processing to the MAX GPIO driver,
- * which then calls the registered callback.
+ * which then calls the registered callback for each pin.
  */
 void GPIO1_IRQHandler(void)
 {
@@ -131,14 +776,14 @@ void GPIO1_IRQHandler(void)
 
 /***** GPIO setup *****/
 /*
- * Configures the GPIO pin connected to the ADXL343 interrupt line.
+ * Configures the GPIO pin connected to a sensor interrupt line.
  * Interrupt is triggered on a rising edge.
  */
-static void setup_gpio_interrupt(void)
+static void setup_gpio_interrupt(motion_sensor *s)
 {
     mxc_gpio_cfg_t cfg = {
-        .port  = ADXL343_INT_PORT,
-        .mask  = (1 << ADXL343_INT_PIN),
+        .port  = MOTION_INT_PORT,
+        .mask  = (1 << s->place->int_pin),
         .pad   = MXC_GPIO_PAD_NONE,
         .func  = MXC_GPIO_FUNC_IN,
         .vssel = MXC_GPIO_VSSEL_VDDIOH
@@ -150,80 +795,317 @@ static void setup_gpio_interrupt(void)
     // Enable rising-edge interrupt
     MXC_GPIO_IntConfig(&cfg, MXC_GPIO_INT_RISING);
 
-    // Register ISR callback
-    MXC_GPIO_RegisterCallback(&cfg, gpio_irq_handler, NULL);
+    // Register ISR callback (the sensor is the callback data)
+    MXC_GPIO_RegisterCallback(&cfg, gpio_irq_handler, s);
 
     // Enable GPIO interrupt
     MXC_GPIO_EnableInt(cfg.port, cfg.mask);
+    MXC_GPIO_ClearFlags(cfg.port, cfg.mask);
 
     // Enable GPIO interrupt at NVIC level
     NVIC_EnableIRQ(GPIO1_IRQn);
 }
 
+
+/***** Sensor discovery *****/
 /*
- * Initializes motion detection:
- *  - stores caller-provided queue
- *  - configures ADXL343 thresholds and interrupts
- *  - sets up GPIO interrupt
- *  - starts motion detection task
+ * Probes every placement and initialises the sensors that answer.
+ * Runs before the scheduler starts (SPI transfers are polled).
+ * Returns the number of sensors found.
  */
-int adxl343_motion_start(void)
+int adxl343_motion_probe(void)
 {
-    // Create binary semaphore for ISR-to-task signaling
-    motionSem = xSemaphoreCreateBinary();
-    if (!motionSem)
-        return -1;
+    int found = 0;
 
-    /* ---------- Sensor configuration ---------- */
+    for (uint8_t i = 0; i < MOTION_MAX_SENSORS; i++) {
+        motion_sensor *s = &sensors[i];
 
-    // Tap detection configuration
-    // Threshold chosen to balance sensitivity vs false positives
-    adxl343_write_reg(ADXL343_THRESH_TAP,   30);
-    adxl343_write_reg(ADXL343_DUR,          20);
-    adxl343_write_reg(ADXL343_LATENT,       40);
-    adxl343_write_reg(ADXL343_WINDOW,      100);
-    adxl343_write_reg(ADXL343_TAP_AXES,   0x07); // Enable X, Y, Z axes
+        s->dev.id = i;
+        s->dev.ss = placements[i].ss;
+        s->place = &placements[i];
+        s->present = (adxl343_init(&s->dev) == E_NO_ERROR);
 
-    // Activity / inactivity configuration
-    adxl343_write_reg(ADXL343_THRESH_ACT,   60);
-    adxl343_write_reg(ADXL343_THRESH_INACT, 20);
-    adxl343_write_reg(ADXL343_TIME_INACT,   50);
-    adxl343_write_reg(ADXL343_ACT_INACT_CTL, 0x70);
+        if (s->present)
+            found++;
+    }
 
-    // Free-fall detection configuration
-    adxl343_write_reg(ADXL343_THRESH_FF, 9);
-    adxl343_write_reg(ADXL343_TIME_FF,  20);
+    return found;
+}
+
+
+/***** Sensor configuration *****/
+/*
+ * Brings one sensor from measure mode to fully configured:
+ * FIFO, profile thresholds, interrupts, power mode.
+ */
+static int configure_sensor(motion_sensor *s, alarm_state state)
+{
+    const power_mode *m = power_mode_for_state(state);
+
+    motion_dsp_init(&s->shake_dsp);
+    vib_classifier_init(&s->vib);
+    s->reported_shake = SHAKE_NONE;
+
+    // One-shot timer ending the ACTIVITY mask window
+    s->activity_rearm_timer = xTimerCreateStatic("ActRearm",
+                                                 pdMS_TO_TICKS(ACTIVITY_COOLDOWN_MS),
+                                                 pdFALSE,
+                                                 s,
+                                                 activity_rearm_callback,
+                                                 &s->activity_rearm_timer_buffer);
+
+    spi_bus_acquire(SPI_BUS_WAIT_FOREVER);
 
     // Route all interrupts to INT1 pin
-    adxl343_write_reg(ADXL343_INT_MAP, 0x00);
+    int ret = adxl343_write_reg(&s->dev, ADXL343_INT_MAP, 0x00);
+
+    s->int_enable_mask = ADXL343_INT_MOTION;
+
+#if MOTION_STREAM_ENABLE
+    // Stream mode: FIFO keeps the newest 32 samples and raises WATERMARK
+    // once MOTION_FIFO_WATERMARK of them are waiting (interrupts only in
+    // the streaming power modes)
+    if (ret == E_NO_ERROR)
+        ret = adxl343_fifo_config(&s->dev, ADXL343_FIFO_STREAM, MOTION_FIFO_WATERMARK);
+    if (m->stream)
+        s->int_enable_mask |= ADXL343_INT_WATERMARK | ADXL343_INT_OVERRUN;
+#endif
+
+    // Thresholds + enable desired interrupt sources
+    if (ret == E_NO_ERROR)
+        ret = apply_profile(s, active_profile);
 
-    // Enable desired interrupt sources
-    adxl343_write_reg(
-        ADXL343_INT_ENABLE,
-        ADXL343_INT_DOUBLE_TAP |
-        ADXL343_INT_ACTIVITY   |
-        ADXL343_INT_FREE_FALL
-    );
+    // Rate / sleep mode for the current alarm state
+    if (ret == E_NO_ERROR)
+        ret = adxl343_set_power_mode(&s->dev, m->bw_rate, m->power_ctl);
 
     // Clear any latched interrupts
     uint8_t dummy;
-    adxl343_read_regs(ADXL343_INT_SOURCE, &dummy, 1);
+    adxl343_read_regs(&s->dev, ADXL343_INT_SOURCE, &dummy, 1);
+
+    spi_bus_release();
+
+    return ret;
+}
+
+/*
+ * Initializes motion detection:
+ *  - configures thresholds and interrupts on every sensor found
+ *  - sets up one GPIO interrupt per sensor
+ * A sensor that fails configuration is dropped; start fails only if
+ * none are left.
+ */
+int adxl343_motion_start(void)
+{
+    // ISRs, timers and other tasks wake this task through its notification
+    motion_task = xTaskGetCurrentTaskHandle();
+
+    spsc_ring_init(&edge_ring, "motion_edges", edge_storage,
+                   sizeof(motion_edge), MOTION_EDGE_RING_SIZE);
+
+    // Rate / sleep mode for whatever state AlertControlTask reported so far
+    alarm_state state = requested_state;
 
-    // Configure GPIO interrupt for ADXL343 INT pin
-    setup_gpio_interrupt();
-    MXC_GPIO_ClearFlags(ADXL343_INT_PORT,
-                        (1 << ADXL343_INT_PIN));
+    FOR_EACH_SENSOR(s) {
+        if (configure_sensor(s, state) != E_NO_ERROR)
+            s->present = false;
+    }
+
+    const power_mode *m = power_mode_for_state(state);
+    current_odr_hz = m->odr_hz;
+    applied_state = state;
+
+    if (adxl343_motion_sensor_count() == 0)
+        return -1;
+
+    // Configure GPIO interrupt for each sensor INT pin
+    FOR_EACH_SENSOR(s)
+        setup_gpio_interrupt(s);
 
     // Successfully configured motion detection
     return 0;
 }
 
 
+/***** Per-sensor event handling *****/
+/*
+ * Reads INT_SOURCE, masks ACTIVITY for the cooldown window if it fired,
+ * and drains the FIFO, repeating until no enabled source is left latched
+ * (see MOTION_SERVICE_PASSES). Returns the INT_SOURCE bits to act on.
+ * activity_seen is set when this edge delivered a fresh ACTIVITY;
+ * still_latched if INT1 may still be high after the last pass.
+ */
+static uint8_t service_sensor(motion_sensor *s, uint32_t edge_ts, bool *activity_seen,
+                              bool *still_latched)
+{
+    // Own the bus for the whole INT_SOURCE read + FIFO drain sequence
+    spi_bus_acquire(SPI_BUS_WAIT_FOREVER);
+
+    // Reading INT_SOURCE clears the interrupt inside the ADXL343
+    uint8_t pending = 0;
+    uint8_t flags = 0;
+    adxl343_read_regs(&s->dev, ADXL343_INT_SOURCE, &pending, 1);
+
+    // Edge-to-service latency (ISR + scheduling + SPI read)
+    uint32_t latency_us = timestamp_ticks_to_us(timestamp_now() - edge_ts);
+    taskENTER_CRITICAL();
+    s->irq_stats.last_latency_us = latency_us;
+    if (latency_us > s->irq_stats.max_latency_us)
+        s->irq_stats.max_latency_us = latency_us;
+    taskEXIT_CRITICAL();
+
+    *activity_seen = false;
+    *still_latched = false;
+
+    uint8_t pass;
+    for (pass = 0; pass < MOTION_SERVICE_PASSES; pass++)
+    {
+        // A source that latched after the previous read (or a FIFO still
+        // at the watermark) holds INT1 high: pick it up now
+        if (pass > 0)
+        {
+            adxl343_read_regs(&s->dev, ADXL343_INT_SOURCE, &pending, 1);
+            pending &= s->int_enable_mask;
+            if (pending == 0)
+                break;
+        }
+
+        // First ACTIVITY of a burst: keep it, mask the rest of the window.
+        // The bit can still be latched alongside a FIFO interrupt while
+        // masked - that one is dropped here.
+        if (pending & ADXL343_INT_ACTIVITY)
+        {
+            if (s->int_enable_mask & ADXL343_INT_ACTIVITY)
+            {
+                *activity_seen = true;
+                activity_mask(s);
+
+                // Sleepy mode: stream until the cooldown window ends
+                if (!power_mode_for_state(applied_state)->stream &&
+                    !(s->int_enable_mask & ADXL343_INT_WATERMARK))
+                {
+                    s->stream_stats.bursts++;
+                    set_streaming(s, true);
+                }
+            }
+            else
+            {
+                pending &= ~ADXL343_INT_ACTIVITY;
+                s->activity_stats.suppressed++;
+            }
+        }
+
+        // Pull queued samples before handling event bits
+        if (pending & (ADXL343_INT_WATERMARK | ADXL343_INT_OVERRUN))
+        {
+            if (pending & ADXL343_INT_OVERRUN)
+                s->stream_stats.fifo_overruns++;
+            drain_fifo(s);
+        }
+
+        flags |= pending;
+    }
+
+    // Out of passes: the pin level says whether anything is still latched
+    // (without a read that would clear it)
+    if (pass == MOTION_SERVICE_PASSES)
+        *still_latched = MXC_GPIO_InGet(MOTION_INT_PORT, 1 << s->place->int_pin) != 0;
+
+    spi_bus_release();
+
+    return flags;
+}
+
+/*
+ * Maps one sensor's interrupt bits and shake severity to a candidate
+ * warning. Returns false if this sensor has nothing to report.
+ */
+static bool evaluate_sensor(motion_sensor *s, uint8_t flags, shake_severity shake,
+                            bool activity_seen, warn_type *evt)
+{
+    bool send = true;
+
+    // Building / plant vibration: drop the ambiguous sources
+    if (vib_classifier_class(&s->vib) == VIB_BACKGROUND)
+    {
+        if ((flags & ADXL343_INT_ACTIVITY) ||
+            shake == SHAKE_LOW || shake == SHAKE_MED)
+        {
+            s->vib.stats.suppressed++;
+        }
+        flags &= ~ADXL343_INT_ACTIVITY;
+        if (shake != SHAKE_HIGH)
+            shake = SHAKE_NONE;
+    }
+
+    /* Highest priority first */
+    if ((flags & ADXL343_INT_FREE_FALL) || shake == SHAKE_HIGH)
+    {
+        // Free fall / violent shaking is treated as highest severity
+        *evt = HIGH_WARN;
+    }
+    else if ((flags & ADXL343_INT_DOUBLE_TAP) || shake == SHAKE_MED)
+    {
+        // Double tap / sustained shaking is medium severity
+        *evt = MED_WARN;
+    }
+    else if ((flags & ADXL343_INT_ACTIVITY) || shake == SHAKE_LOW)
+    {
+        // Rate-limit activity events to avoid queue flooding. ACTIVITY
+        // only gets here once per mask window, so the tick gate is for
+        // SHAKE_LOW alone (a second gate would eat the first ACTIVITY
+        // after each re-arm).
+        TickType_t now = xTaskGetTickCount();
+        if ((flags & ADXL343_INT_ACTIVITY) ||
+            (now - s->last_activity_tick) > pdMS_TO_TICKS(ACTIVITY_COOLDOWN_MS))
+        {
+            *evt = LOW_WARN;
+            s->last_activity_tick = now;
+        }
+        else
+        {
+            send = false;
+        }
+    }
+    else
+    {
+        // No relevant event detected
+        send = false;
+    }
+
+    if (activity_seen)
+    {
+        if (send)
+            s->activity_stats.delivered++;
+        else
+            s->activity_stats.suppressed++;
+    }
+
+    return send;
+}
+
+// True if any sensor other than source moved within the fusion window of tick
+static bool corroborated(const motion_sensor *source, TickType_t tick)
+{
+    FOR_EACH_SENSOR(s) {
+        if (s == source || !s->motion_seen)
+            continue;
+
+        TickType_t delta = (tick >= s->last_motion_tick) ?
+                           tick - s->last_motion_tick :
+                           s->last_motion_tick - tick;
+        if (delta <= pdMS_TO_TICKS(FUSION_WINDOW_MS))
+            return true;
+    }
+    return false;
+}
+
+
 /***** Motion detection task *****/
 /*
- * This task waits for motion interrupts signaled by the ISR.
- * It prioritizes events and sends the highest-priority warning
- * to the motion queue.
+ * This task waits for motion interrupts signaled by the ISRs.
+ * It services every sensor with a pending edge, fuses their candidate
+ * warnings and sends the highest-priority one to the motion queue.
  */
 void MotionDetectionTask(void *arg)
 {
@@ -233,53 +1115,162 @@ void MotionDetectionTask(void *arg)
 
     for (;;)
     {
-        // Wait indefinitely for a motion interrupt
-        xSemaphoreTake(motionSem, portMAX_DELAY);
+        // Wait indefinitely for a motion interrupt or a request
+        uint32_t signals = task_signal_wait(MOTION_SIGNALS, portMAX_DELAY);
+
+        // Profile switch requested over UART
+        if (signals & TASK_SIGNAL_MOTION_PROFILE)
+        {
+            // Re-enabling INT_ENABLE re-asserts INT1 if any source is
+            // still latched, so pending watermarks produce a fresh edge
+            apply_profile_all(profile_request);
+        }
+
+        // Alarm state changed - switch rate / sleep mode first
+        if (signals & TASK_SIGNAL_MOTION_STATE)
+        {
+            taskENTER_CRITICAL();
+            alarm_state target = requested_state;
+            uint32_t requested_at = state_request_ts;
+            taskEXIT_CRITICAL();
+
+            if (power_mode_for_state(target) != power_mode_for_state(applied_state))
+            {
+                int ret = apply_power_mode(target);
 
-        // Copy and clear accumulated interrupt flags
-        uint8_t flags = motion_flags;
-        motion_flags = 0;
+                uint32_t latency_us = timestamp_ticks_to_us(timestamp_now() - requested_at);
 
-        warn_type evt;
-        uint8_t send = 1;
+                taskENTER_CRITICAL();
+                if (ret == E_NO_ERROR)
+                    power_stats.transitions++;
+                else
+                    power_stats.errors++;
+                power_stats.last_reconfig_us = latency_us;
+                if (latency_us > power_stats.max_reconfig_us)
+                    power_stats.max_reconfig_us = latency_us;
+                taskEXIT_CRITICAL();
+            }
+            else
+            {
+                applied_state = target;
+            }
+        }
 
-        /* Highest priority first */
-        if (flags & ADXL343_INT_FREE_FALL)
+        // Hand the edges captured by the ISR to their sensors
+        motion_edge edge;
+        while (spsc_ring_pop(&edge_ring, &edge))
         {
-            // Free fall is treated as highest severity
-            evt = HIGH_WARN;
+            motion_sensor *s = sensor_by_id(edge.device);
+            if (s == NULL)
+                continue;
+
+            if (s->capture_pending)
+            {
+                s->irq_stats.coalesced++;
+                continue;
+            }
+            s->capture_ts = edge.ts;
+            s->capture_tick = edge.tick;
+            s->capture_pending = true;
         }
-        else if (flags & ADXL343_INT_DOUBLE_TAP)
+
+        // Edges the ring had no room for: the capture time is lost, but
+        // the sensor is serviced (timed from now)
+        taskENTER_CRITICAL();
+        uint32_t overflowed = edge_overflow;
+        edge_overflow = 0;
+        taskEXIT_CRITICAL();
+
+        FOR_EACH_SENSOR(s)
         {
-            // Double tap is medium severity
-            evt = MED_WARN;
+            if (!(overflowed & (1u << s->dev.id)) || s->capture_pending)
+                continue;
+
+            s->capture_ts = timestamp_now();
+            s->capture_tick = xTaskGetTickCount();
+            s->capture_pending = true;
         }
-        else if (flags & ADXL343_INT_ACTIVITY)
+
+        motion_sensor *source = NULL;
+        warn_type fused = LOW_WARN;
+        TickType_t fused_tick = 0;
+
+        FOR_EACH_SENSOR(s)
         {
-            // Rate-limit activity events to avoid queue flooding
-            TickType_t now = xTaskGetTickCount();
-            if ((now - last_activity_tick) >
-                pdMS_TO_TICKS(ACTIVITY_COOLDOWN_MS))
+            // Activity cooldown over - re-enable the interrupt and end
+            // any ACTIVITY-started burst of streaming
+            if (signals & TASK_SIGNAL_MOTION_REARM(s - sensors))
             {
-                evt = LOW_WARN;
-                last_activity_tick = now;
+                spi_bus_acquire(SPI_BUS_WAIT_FOREVER);
+                activity_unmask(s);
+                set_streaming(s, power_mode_for_state(applied_state)->stream);
+                spi_bus_release();
             }
-            else
+
+            // Take the edge capture recorded by the ISR
+            if (!s->capture_pending)
+                continue;
+
+            uint32_t edge_ts = s->capture_ts;
+            TickType_t edge_tick = s->capture_tick;
+            s->capture_pending = false;
+
+            // Sensor edge woke the system - wake-up-to-event latency
+            low_power_mark_event();
+
+            bool activity_seen;
+            bool still_latched;
+            uint8_t flags = service_sensor(s, edge_ts, &activity_seen, &still_latched);
+
+            // INT1 is still high, so no edge will come: service it again
+            if (still_latched)
             {
-                send = 0;
+                s->capture_ts = timestamp_now();
+                s->capture_tick = xTaskGetTickCount();
+                s->capture_pending = true;
+                s->irq_stats.relatched++;
+                task_signal_raise(motion_task, TASK_SIGNAL_MOTION_EDGE);
+            }
+
+            // Graded shake severity from the sample stream (if streaming)
+            shake_severity shake = process_sample_blocks(s);
+
+            if ((flags & ADXL343_INT_MOTION) || shake != SHAKE_NONE)
+            {
+                s->motion_seen = true;
+                s->last_motion_tick = edge_tick;
+            }
+
+            warn_type evt;
+            if (evaluate_sensor(s, flags, shake, activity_seen, &evt) &&
+                (source == NULL || evt > fused))
+            {
+                source = s;
+                fused = evt;
+                fused_tick = edge_tick;
             }
-        }
-        else
-        {
-            // No relevant event detected
-            send = 0;
         }
 
-        // Send event to queue if valid
-        if (send)
+        if (source == NULL)
+            continue;
+
+        // Movement on more than one sensor: the case itself is moving
+        if (fused == LOW_WARN && corroborated(source, fused_tick))
         {
-            motion_event motion = {evt};
-            xQueueSend(motion_queue, &motion, 0);
+            fused = MED_WARN;
+            fusion_stats.corroborated++;
         }
+        fusion_stats.decisions++;
+
+        alert_event motion = {
+            .source = EVENT_SOURCE_MOTION,
+            .timestamp = fused_tick,
+            .motion = {
+                .warning = fused,
+                .capture_tick = fused_tick,
+                .device_id = source->dev.id
+            }
+        };
+        event_bus_publish(&motion);
     }
 }
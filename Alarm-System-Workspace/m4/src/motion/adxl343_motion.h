@@ -4,14 +4,145 @@
 #include <stdint.h>
 #include "FreeRTOS.h"
 #include "queue.h"
+#include "adxl343.h"
+#include "motion_dsp.h"
+#include "vibration_classifier.h"
+#include "../utils/typing.h"
+
+
+/***** Sensor profiles *****/
+/*
+ * Named threshold sets for the tap / activity / free-fall block.
+ * Switchable at runtime with the PROF:<name> UART command.
+ */
+typedef enum motion_profile {
+    MOTION_PROFILE_MUSEUM_QUIET = 0,
+    MOTION_PROFILE_HIGH_TRAFFIC,
+    MOTION_PROFILE_TRANSPORT,
+    MOTION_PROFILE_COUNT
+} motion_profile;
+
+
+/***** Interrupt statistics *****/
+typedef struct motion_irq_stats {
+    uint32_t irq_count;        // GPIO edges seen by the ISR
+    uint32_t coalesced;        // Edges that arrived while an earlier one was still pending
+    uint32_t last_latency_us;  // Edge to INT_SOURCE read, most recent event
+    uint32_t max_latency_us;   // Worst edge to INT_SOURCE read seen so far
+    uint32_t relatched;        // INT1 still high after servicing - serviced again
+} motion_irq_stats;
+
+
+/***** Activity interrupt statistics *****/
+typedef struct motion_activity_stats {
+    uint32_t delivered;        // ACTIVITY interrupts that produced an event
+    uint32_t suppressed;       // ACTIVITY seen but dropped (cooldown, background, masked)
+    uint32_t mask_windows;     // Times ACTIVITY was masked for a cooldown window
+} motion_activity_stats;
+
+
+/***** Power mode statistics *****/
+typedef struct motion_power_stats {
+    uint32_t transitions;       // Rate / sleep mode changes applied
+    uint32_t errors;            // Changes that failed on the bus
+    uint32_t last_reconfig_us;  // State notification to registers written
+    uint32_t max_reconfig_us;   // Worst case seen so far
+} motion_power_stats;
+
+
+/***** Streaming statistics *****/
+typedef struct motion_stream_stats {
+    uint32_t blocks_read;      // FIFO drains (one per watermark interrupt)
+    uint32_t samples_read;     // XYZ samples moved into the ring
+    uint32_t samples_dropped;  // Oldest samples overwritten in a full ring
+    uint32_t fifo_overruns;    // Sensor FIFO filled before it was drained
+    uint32_t read_errors;      // SPI errors while draining
+    uint32_t bursts;           // Streaming started by ACTIVITY in a sleepy power mode
+} motion_stream_stats;
+
+
+/***** Fusion statistics *****/
+typedef struct motion_fusion_stats {
+    uint32_t decisions;        // Fused warnings published to the event bus
+    uint32_t corroborated;     // LOW raised to MED by a second sensor
+} motion_fusion_stats;
+
+
+/***** Sensors *****/
+/*
+ * Up to MOTION_MAX_SENSORS accelerometers (lid, base, plinth) share SPI1.
+ * The device argument of the per-sensor calls below is the sensor index,
+ * the same value carried as device_id in motion and cloud events.
+ */
+#define MOTION_MAX_SENSORS 3
+
+/*
+ * Probes and initialises every sensor position (before the scheduler).
+ * Returns the number of sensors that answered.
+ */
+int adxl343_motion_probe(void);
+
+uint8_t adxl343_motion_sensor_count(void);
+const char *adxl343_motion_sensor_name(uint8_t device);
 
 
 /***** Motion detection task *****/
 /*
- * This task waits for motion interrupts signaled by the ISR.
- * It prioritizes events and sends the highest-priority warning
- * to the motion queue.
+ * This task waits for motion interrupts signaled by the ISRs.
+ * It fuses per-sensor warnings into one decision and sends the
+ * highest-priority warning to the motion queue.
  */
 void MotionDetectionTask(void *arg);
 
+/*
+ * Copies up to max buffered samples (oldest first) out of a sensor's
+ * sample ring. Returns the number of samples copied, or -1 for an
+ * unknown device. Call from MotionDetectionTask context.
+ */
+int adxl343_motion_read_samples(uint8_t device, adxl343_sample_t *out, uint32_t max);
+
+/*
+ * Per-sensor snapshots. Each returns 0, or -1 if the device is not fitted.
+ */
+// Streaming counters
+int adxl343_motion_get_stream_stats(uint8_t device, motion_stream_stats *stats);
+
+// Shake pipeline per-block cycle accounting
+int adxl343_motion_get_dsp_stats(uint8_t device, motion_dsp_stats *stats);
+
+// Vibration classifier counters and per-window cycle cost
+int adxl343_motion_get_vib_stats(uint8_t device, vib_stats *stats);
+
+// ACTIVITY delivered / suppressed counters
+int adxl343_motion_get_activity_stats(uint8_t device, motion_activity_stats *stats);
+
+// Interrupt counters and edge-to-service latency
+int adxl343_motion_get_irq_stats(uint8_t device, motion_irq_stats *stats);
+
+// Snapshot of the fusion counters
+void adxl343_motion_get_fusion_stats(motion_fusion_stats *stats);
+
+/*
+ * Tells the motion subsystem the current alarm state (task context).
+ * Quiet states use low-power sampling with auto-sleep, warning states
+ * switch to full rate.
+ */
+void adxl343_motion_notify_state(alarm_state state);
+
+// BW_RATE rate code used in a given state (Hz = 3200 / 2^(15 - code))
+uint8_t adxl343_motion_odr_code_for_state(alarm_state state);
+
+// Snapshot of the reconfiguration counters and latency
+void adxl343_motion_get_power_stats(motion_power_stats *stats);
+
+/*
+ * Requests a profile switch (task context); the motion task programs
+ * and verifies the registers the next time it runs.
+ */
+void adxl343_motion_request_profile(motion_profile id);
+
+// Profile currently programmed into the sensor
+motion_profile adxl343_motion_get_profile(void);
+const char *adxl343_motion_profile_name(motion_profile id);
+
 #endif
@@ -0,0 +1,134 @@
+#include "motion_dsp.h"
+#include <string.h>
+#include "../utils/cycle_counter.h"
+
+/*
+ * ============================================================================
+ * Motion feature pipeline (Q15)
+ * ============================================================================
+ * Raw full-resolution counts are 1/256 g. Shifting left by 5 puts 1 g at
+ * 8192, so the Q15 range [-1, 1) covers +/-4 g with headroom for the
+ * +/-2 g sensor range plus baseline subtraction.
+ */
+#define RAW_TO_Q15_SHIFT 5
+#define MG_TO_Q15(mg) ((q15_t)(((int32_t)(mg) * 8192) / 1000))
+
+
+void motion_dsp_init(motion_dsp *dsp)
+{
+    memset(dsp, 0, sizeof(*dsp));
+    cycle_counter_init();
+}
+
+
+/***** Severity grading *****/
+static shake_severity grade(q15_t rms, q15_t peak)
+{
+    if (rms >= MG_TO_Q15(MOTION_DSP_HIGH_RMS_MG) ||
+        peak >= MG_TO_Q15(MOTION_DSP_HIGH_PEAK_MG))
+        return SHAKE_HIGH;
+
+    if (rms >= MG_TO_Q15(MOTION_DSP_MED_RMS_MG) ||
+        peak >= MG_TO_Q15(MOTION_DSP_MED_PEAK_MG))
+        return SHAKE_MED;
+
+    if (rms >= MG_TO_Q15(MOTION_DSP_LOW_RMS_MG))
+        return SHAKE_LOW;
+
+    return SHAKE_NONE;
+}
+
+
+/***** Block processing *****/
+shake_severity motion_dsp_process_block(motion_dsp *dsp,
+                                        const adxl343_sample_t *samples,
+                                        q15_t hp_axes[3][MOTION_DSP_BLOCK_SIZE])
+{
+    q15_t axis[3][MOTION_DSP_BLOCK_SIZE];
+    q15_t sq[MOTION_DSP_BLOCK_SIZE];
+    q15_t mag_sq[MOTION_DSP_BLOCK_SIZE];
+    q63_t energy = 0;
+
+    uint32_t start = cycle_counter_now();
+
+    // De-interleave XYZ into per-axis vectors
+    for (uint32_t i = 0; i < MOTION_DSP_BLOCK_SIZE; i++) {
+        axis[0][i] = samples[i].x;
+        axis[1][i] = samples[i].y;
+        axis[2][i] = samples[i].z;
+    }
+
+    for (uint32_t a = 0; a < 3; a++) {
+        q15_t mean;
+
+        arm_shift_q15(axis[a], RAW_TO_Q15_SHIFT, axis[a], MOTION_DSP_BLOCK_SIZE);
+
+        // High-pass: track gravity with a block-rate EMA and subtract it
+        arm_mean_q15(axis[a], MOTION_DSP_BLOCK_SIZE, &mean);
+        if (!dsp->baseline_valid) {
+            dsp->baseline[a] = mean;
+        } else {
+            dsp->baseline[a] += (q15_t)((mean - dsp->baseline[a]) >>
+                                        MOTION_DSP_GRAVITY_SHIFT);
+        }
+        arm_offset_q15(axis[a], (q15_t)-dsp->baseline[a], axis[a],
+                       MOTION_DSP_BLOCK_SIZE);
+
+        // Exact sum of squares (34.30) for the energy estimate
+        q63_t power;
+        arm_power_q15(axis[a], MOTION_DSP_BLOCK_SIZE, &power);
+        energy += power;
+
+        // Per-sample |a|^2 for the peak estimate
+        if (a == 0) {
+            arm_mult_q15(axis[a], axis[a], mag_sq, MOTION_DSP_BLOCK_SIZE);
+        } else {
+            arm_mult_q15(axis[a], axis[a], sq, MOTION_DSP_BLOCK_SIZE);
+            arm_add_q15(mag_sq, sq, mag_sq, MOTION_DSP_BLOCK_SIZE);
+        }
+    }
+    dsp->baseline_valid = 1;
+
+    if (hp_axes != NULL)
+        memcpy(hp_axes, axis, sizeof(axis));
+
+    // Mean |a|^2 for the block: Q30 -> Q31 with saturation
+    q63_t mean_q30 = energy / MOTION_DSP_BLOCK_SIZE;
+    q31_t block_energy = (mean_q30 >= 0x40000000) ?
+                         0x7FFFFFFF : (q31_t)(mean_q30 << 1);
+
+    q15_t block_peak;
+    uint32_t peak_index;
+    arm_max_q15(mag_sq, MOTION_DSP_BLOCK_SIZE, &block_peak, &peak_index);
+
+    dsp->block_energy[dsp->window_index] = block_energy;
+    dsp->block_peak[dsp->window_index] = block_peak;
+    dsp->window_index = (dsp->window_index + 1) % MOTION_DSP_WINDOW_BLOCKS;
+
+    // Sliding window over the last MOTION_DSP_WINDOW_BLOCKS blocks
+    q63_t window_sum = 0;
+    q15_t window_peak_sq = 0;
+    for (uint32_t b = 0; b < MOTION_DSP_WINDOW_BLOCKS; b++) {
+        window_sum += dsp->block_energy[b];
+        if (dsp->block_peak[b] > window_peak_sq)
+            window_peak_sq = dsp->block_peak[b];
+    }
+
+    q31_t rms_q31;
+    arm_sqrt_q31((q31_t)(window_sum / MOTION_DSP_WINDOW_BLOCKS), &rms_q31);
+    dsp->window_rms = (q15_t)(rms_q31 >> 16);
+    arm_sqrt_q15(window_peak_sq, &dsp->window_peak);
+
+    dsp->severity = grade(dsp->window_rms, dsp->window_peak);
+
+    // Cycle accounting
+    uint32_t cycles = cycle_counter_now() - start;
+    dsp->stats.blocks++;
+    dsp->stats.last_cycles = cycles;
+    if (cycles > dsp->stats.max_cycles)
+        dsp->stats.max_cycles = cycles;
+    if (cycles > MOTION_DSP_CYCLE_BUDGET)
+        dsp->stats.over_budget++;
+
+    return dsp->severity;
+}
@@ -0,0 +1,75 @@
+#ifndef MOTION_DSP_H
+#define MOTION_DSP_H
+
+#include <stdint.h>
+#include "arm_math.h"
+#include "adxl343.h"
+
+/*
+ * Fixed-point (Q15) motion feature pipeline.
+ *
+ * Works on blocks of XYZ samples drained from the sensor FIFO:
+ *  1. Scale raw counts to Q15 (1.0 = 4 g)
+ *  2. High-pass each axis by subtracting a slowly tracked gravity baseline
+ *  3. Per-block energy (sum of squares) and peak vector magnitude
+ *  4. Sliding-window RMS / peak over the last few blocks
+ *  5. Grade the result into a shake severity
+ *
+ * All vector steps use CMSIS-DSP Q15 kernels, which use the M4 SIMD
+ * (dual 16-bit MAC) instructions. Cost is measured per block in cycles.
+ */
+
+#define MOTION_DSP_BLOCK_SIZE    16  // Samples per block (FIFO watermark)
+#define MOTION_DSP_WINDOW_BLOCKS 8   // Sliding window length in blocks
+#define MOTION_DSP_GRAVITY_SHIFT 4   // Baseline tracks 1/16 of each block mean
+#define MOTION_DSP_CYCLE_BUDGET  20000 // Per-block budget (200 us at 100 MHz)
+
+// Severity thresholds on the high-passed vector magnitude (milli-g)
+#define MOTION_DSP_LOW_RMS_MG    50
+#define MOTION_DSP_MED_RMS_MG    150
+#define MOTION_DSP_MED_PEAK_MG   500
+#define MOTION_DSP_HIGH_RMS_MG   400
+#define MOTION_DSP_HIGH_PEAK_MG  1200
+
+typedef enum shake_severity {
+    SHAKE_NONE = 0,
+    SHAKE_LOW,
+    SHAKE_MED,
+    SHAKE_HIGH
+} shake_severity;
+
+// Per-block cycle accounting
+typedef struct motion_dsp_stats {
+    uint32_t blocks;           // Blocks processed
+    uint32_t last_cycles;      // Cost of the most recent block
+    uint32_t max_cycles;       // Worst block so far
+    uint32_t over_budget;      // Blocks above MOTION_DSP_CYCLE_BUDGET
+} motion_dsp_stats;
+
+// Pipeline state (one per sensor)
+typedef struct motion_dsp {
+    q15_t baseline[3];         // Tracked gravity per axis
+    uint8_t baseline_valid;
+    q31_t block_energy[MOTION_DSP_WINDOW_BLOCKS]; // Mean |a|^2 per block
+    q15_t block_peak[MOTION_DSP_WINDOW_BLOCKS];   // Max |a|^2 per block
+    uint32_t window_index;
+    q15_t window_rms;          // Latest window RMS magnitude (Q15)
+    q15_t window_peak;         // Latest window peak magnitude (Q15)
+    shake_severity severity;   // Latest graded severity
+    motion_dsp_stats stats;
+} motion_dsp;
+
+// Reset state (baseline re-learned from the next block)
+void motion_dsp_init(motion_dsp *dsp);
+
+/*
+ * Process exactly MOTION_DSP_BLOCK_SIZE samples.
+ * Returns the graded severity for the sliding window ending at this block.
+ * hp_axes (optional) receives the high-passed Q15 X/Y/Z vectors for
+ * later stages such as the vibration classifier.
+ */
+shake_severity motion_dsp_process_block(motion_dsp *dsp,
+                                        const adxl343_sample_t *samples,
+                                        q15_t hp_axes[3][MOTION_DSP_BLOCK_SIZE]);
+
+#endif /* MOTION_DSP_H */
@@ -0,0 +1,365 @@
+#include "spi_bus.h"
+#include "dma.h"
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+/*
+ * ============================================================================
+ * SPI1 bus owner (Implementation)
+ * ============================================================================
+ * Moves bytes for every device on SPI1. Device drivers build their
+ * command frames and pass the slave-select index of the target.
+ */
+
+
+/***** Async transfer state *****/
+/*
+ * Only one DMA transaction can be in flight at a time.
+ * The request structure must outlive the transfer, so it is static.
+ */
+#define SPI_BUS_TIMEOUT_MS 10
+
+static mxc_spi_req_t async_req;
+static volatile bool async_busy = false;
+static spi_bus_cb_t async_cb = NULL;
+static void *async_ctx = NULL;
+
+// DMA channels the driver picked for the transfer in flight (-1: none)
+static volatile int async_dma_tx = -1;
+static volatile int async_dma_rx = -1;
+
+// Completion state for the blocking wrapper
+static SemaphoreHandle_t xfer_done_sem = NULL;
+static StaticSemaphore_t xfer_done_sem_buffer;
+static volatile int xfer_result;
+
+// Bus ownership between tasks (recursive: sequences nest single transfers)
+static SemaphoreHandle_t bus_mutex = NULL;
+static StaticSemaphore_t bus_mutex_buffer;
+
+
+/***** DMA IRQ handlers *****/
+/*
+ * The SPI driver acquires its DMA channels on demand,
+ * so every channel the driver may pick is routed to the DMA handler.
+ */
+void DMA0_IRQHandler(void) { MXC_DMA_Handler(); }
+void DMA1_IRQHandler(void) { MXC_DMA_Handler(); }
+void DMA2_IRQHandler(void) { MXC_DMA_Handler(); }
+void DMA3_IRQHandler(void) { MXC_DMA_Handler(); }
+
+
+/***** SPI completion callback *****/
+/*
+ * Called by the SPI driver from DMA interrupt context once both
+ * TX and RX channels have finished.
+ */
+static void spi_complete_handler(void *req, int result)
+{
+    (void)req;
+
+    spi_bus_cb_t cb = async_cb;
+    void *ctx = async_ctx;
+
+    // Finished channels are the driver's again - nothing left to abort
+    async_dma_tx = -1;
+    async_dma_rx = -1;
+
+    // Release the bus before the callback so it can chain the next transfer
+    async_busy = false;
+
+    if (cb != NULL) {
+        cb(result, ctx);
+    }
+}
+
+
+/***** Async SPI transfer *****/
+/*
+ * The driver acquires its channels internally and does not say which,
+ * so they are found by their request select once the transfer is set up.
+ */
+static void find_dma_channels(void)
+{
+    async_dma_tx = -1;
+    async_dma_rx = -1;
+
+    for (int ch = 0; ch < MXC_DMA_CHANNELS; ch++) {
+        uint32_t reqsel = MXC_DMA->ch[ch].ctrl & MXC_F_DMA_CTRL_REQUEST;
+
+        if (reqsel == MXC_S_DMA_CTRL_REQUEST_SPI1TX) {
+            async_dma_tx = ch;
+        } else if (reqsel == MXC_S_DMA_CTRL_REQUEST_SPI1RX) {
+            async_dma_rx = ch;
+        }
+    }
+}
+
+/*
+ * Starts a DMA-backed SPI transaction and returns immediately.
+ * cb runs in interrupt context when the transfer completes.
+ *
+ * ss   -> slave-select index of the target device
+ * tx   -> buffer containing bytes to transmit (must stay valid until cb)
+ * rx   -> buffer where received bytes will be stored (must stay valid until cb)
+ * len  -> number of bytes to transfer
+ */
+int spi_bus_xfer_async(int ss, uint8_t *tx, uint8_t *rx, uint32_t len,
+                       spi_bus_cb_t cb, void *ctx)
+{
+    if (async_busy) {
+        return E_BUSY;
+    }
+
+    async_busy = true;
+    async_cb = cb;
+    async_ctx = ctx;
+
+    memset(&async_req, 0, sizeof(async_req));
+    async_req.spi = SPI;
+    async_req.txData = tx;
+    async_req.rxData = rx;
+    async_req.txLen = len;
+    async_req.rxLen = len;
+    async_req.ssIdx = ss;
+    async_req.ssDeassert = 1;
+    async_req.completeCB = spi_complete_handler;
+
+    int ret = MXC_SPI_MasterTransactionDMA(&async_req);
+    if (ret != E_NO_ERROR) {
+        async_busy = false;
+    } else {
+        find_dma_channels();
+    }
+
+    return ret;
+}
+
+bool spi_bus_busy(void)
+{
+    return async_busy;
+}
+
+bool spi_bus_can_block(void)
+{
+    return __get_IPSR() == 0 &&
+           xTaskGetSchedulerState() == taskSCHEDULER_RUNNING;
+}
+
+
+/***** Blocking transfer helpers *****/
+/*
+ * Blocking completion callback: records the result and wakes the waiter.
+ */
+static void blocking_xfer_done(int result, void *ctx)
+{
+    BaseType_t woken = pdFALSE;
+
+    (void)ctx;
+    xfer_result = result;
+    xSemaphoreGiveFromISR(xfer_done_sem, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+/*
+ * Stops a transfer that never completed. The DMA would otherwise keep
+ * writing into the caller's rx buffer (often on its stack) after the
+ * caller has given up, and its late completion would be taken by the
+ * next transfer as its own.
+ */
+static void xfer_abort(void)
+{
+    // Detach first: the abort may report completion through the callback
+    taskENTER_CRITICAL();
+    async_cb = NULL;
+    async_ctx = NULL;
+    int dma_tx = async_dma_tx;
+    int dma_rx = async_dma_rx;
+    async_dma_tx = -1;
+    async_dma_rx = -1;
+    taskEXIT_CRITICAL();
+
+    // Abort alone leaves the channels armed (and owned): stop the RX
+    // side before anything else so no more bytes land in rx
+    if (dma_rx >= 0) {
+        MXC_DMA_Stop(dma_rx);
+    }
+    if (dma_tx >= 0) {
+        MXC_DMA_Stop(dma_tx);
+    }
+
+    MXC_SPI_AbortAsync(SPI);
+
+    if (dma_rx >= 0) {
+        MXC_DMA_ReleaseChannel(dma_rx);
+    }
+    if (dma_tx >= 0) {
+        MXC_DMA_ReleaseChannel(dma_tx);
+    }
+    async_busy = false;
+
+    // A completion that slipped in before the detach
+    xSemaphoreTake(xfer_done_sem, 0);
+}
+
+int spi_bus_xfer_start(int ss, uint8_t *tx, uint8_t *rx, uint32_t len)
+{
+    // Nothing left over from an earlier transfer may count as this one's
+    xSemaphoreTake(xfer_done_sem, 0);
+
+    return spi_bus_xfer_async(ss, tx, rx, len, blocking_xfer_done, NULL);
+}
+
+/*
+ * Waits for a transfer started with spi_bus_xfer_start.
+ * The calling task sleeps on the semaphore while DMA moves the bytes;
+ * on timeout the transfer is aborted before returning.
+ */
+int spi_bus_xfer_wait(void)
+{
+    if (xSemaphoreTake(xfer_done_sem,
+                       pdMS_TO_TICKS(SPI_BUS_TIMEOUT_MS)) != pdPASS) {
+        xfer_abort();
+        return E_TIME_OUT;
+    }
+
+    return xfer_result;
+}
+
+/*
+ * Performs a single blocking SPI transaction.
+ *
+ * From a task it is a thin wrapper over the async path: the bus lock is
+ * taken, the transfer runs on DMA and the task blocks until the completion
+ * interrupt. Before the scheduler starts, or from interrupt context, there
+ * is no task to block and the DMA interrupt may not be able to preempt the
+ * caller, so the transfer is polled instead.
+ */
+int spi_bus_xfer(int ss, uint8_t *tx, uint8_t *rx, uint32_t len)
+{
+    if (spi_bus_can_block()) {
+        if (spi_bus_acquire(SPI_BUS_WAIT_FOREVER) != E_NO_ERROR)
+            return E_TIME_OUT;
+
+        int ret = spi_bus_xfer_start(ss, tx, rx, len);
+        if (ret == E_NO_ERROR)
+            ret = spi_bus_xfer_wait();
+
+        spi_bus_release();
+        return ret;
+    }
+
+    // Polled fallback - the bus must not be in use by a DMA transfer
+    if (async_busy) {
+        return E_BUSY;
+    }
+
+    // SPI transaction request structure
+    mxc_spi_req_t req = {0};
+
+    // Select SPI peripheral (SPI1)
+    req.spi = SPI;
+
+    // Transmit and receive buffers
+    req.txData = tx;
+    req.rxData = rx;
+
+    // Number of bytes to transmit and receive
+    req.txLen = len;
+    req.rxLen = len;
+
+    // Which slave-select line to use
+    req.ssIdx = ss;
+
+    // Release slave-select line after transfer completes
+    req.ssDeassert = 1;
+
+    // Transfer counters (managed by driver)
+    req.txCnt = 0;
+    req.rxCnt = 0;
+
+    // Blocking transfer, no callback function
+    req.completeCB = NULL;
+
+    // Execute SPI transaction
+    return MXC_SPI_MasterTransaction(&req);
+}
+
+
+/***** SPI initialization *****/
+/*
+ * Initializes the SPI peripheral for the ADXL343 devices.
+ * This must be called before any sensor communication.
+ *
+ * pins -> structure defining which SPI pins (and SS lines) are enabled
+ */
+int spi_bus_init(const mxc_spi_pins_t *pins)
+{
+    // Count how many slave-select pins are enabled
+    uint32_t num_slaves = pins->ss0 + pins->ss1 + pins->ss2;
+
+    // At least one SS line must be enabled
+    if (num_slaves == 0) {
+        return E_BAD_PARAM;
+    }
+
+    // Initialize SPI in master mode
+    int ret = MXC_SPI_Init(SPI, 1, 0, num_slaves, 0, SPI_SPEED, *pins);
+    if (ret != E_NO_ERROR) return ret;
+
+    // Configure SPI for 8-bit data frames
+    ret = MXC_SPI_SetDataSize(SPI, 8);
+    if (ret != E_NO_ERROR) return ret;
+
+    // Standard single-wire SPI
+    ret = MXC_SPI_SetWidth(SPI, SPI_WIDTH_STANDARD);
+    if (ret != E_NO_ERROR) return ret;
+
+    // SPI Mode 3: CPOL = 1, CPHA = 1 (required by ADXL343)
+    ret = MXC_SPI_SetMode(SPI, SPI_MODE_3);
+    if (ret != E_NO_ERROR) return ret;
+
+    // Completion semaphore for blocking transfers on the DMA path
+    if (xfer_done_sem == NULL) {
+        xfer_done_sem = xSemaphoreCreateBinaryStatic(&xfer_done_sem_buffer);
+        if (xfer_done_sem == NULL) return E_NONE_AVAIL;
+    }
+
+    if (bus_mutex == NULL) {
+        bus_mutex = xSemaphoreCreateRecursiveMutexStatic(&bus_mutex_buffer);
+        if (bus_mutex == NULL) return E_NONE_AVAIL;
+    }
+
+    // Enable DMA channel interrupts used by the SPI driver
+    NVIC_EnableIRQ(DMA0_IRQn);
+    NVIC_EnableIRQ(DMA1_IRQn);
+    NVIC_EnableIRQ(DMA2_IRQn);
+    NVIC_EnableIRQ(DMA3_IRQn);
+
+    return E_NO_ERROR;
+}
+
+
+/***** Bus ownership *****/
+/*
+ * Task-level users take the bus around every register sequence
+ * (e.g. INT_SOURCE read + FIFO drain) so sequences never interleave,
+ * whichever slave-select line they target.
+ * Not for interrupt context - ISRs must not touch the sensors.
+ */
+int spi_bus_acquire(uint32_t timeout_ms)
+{
+    TickType_t ticks = (timeout_ms == SPI_BUS_WAIT_FOREVER) ?
+                       portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+
+    return (xSemaphoreTakeRecursive(bus_mutex, ticks) == pdPASS) ?
+           E_NO_ERROR : E_TIME_OUT;
+}
+
+void spi_bus_release(void)
+{
+    xSemaphoreGiveRecursive(bus_mutex);
+}
@@ -0,0 +1,63 @@
+#ifndef SPI_BUS_H
+#define SPI_BUS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "mxc_device.h"
+#include "spi.h"
+
+/*
+ * Shared SPI1 bus owner.
+ *
+ * Every accelerometer sits on SPI1 behind its own slave-select line.
+ * This layer owns the peripheral, the DMA completion path and the
+ * bus lock, so transactions to different SS lines never interleave.
+ *
+ * Single transfers take the lock themselves. Multi-transaction sequences
+ * (INT_SOURCE read + FIFO drain, profile write + readback) wrap the whole
+ * sequence in spi_bus_acquire / spi_bus_release; the lock is recursive,
+ * so the transfers inside nest cleanly.
+ */
+
+#define SPI_SPEED 1000000
+
+#define SPI MXC_SPI1
+
+#define SPI_BUS_WAIT_FOREVER 0xFFFFFFFF
+
+/*
+ * Async transfer completion callback.
+ * Runs in DMA interrupt context - keep it short and use FromISR APIs only.
+ */
+typedef void (*spi_bus_cb_t)(int result, void *ctx);
+
+int spi_bus_init(const mxc_spi_pins_t *pins);
+
+// Bus ownership for task-level register sequences (recursive)
+int spi_bus_acquire(uint32_t timeout_ms);
+void spi_bus_release(void);
+
+// Blocking full-duplex transfer on slave-select ss
+int spi_bus_xfer(int ss, uint8_t *tx, uint8_t *rx, uint32_t len);
+
+/*
+ * Non-blocking DMA transfer (one in flight at a time, E_BUSY otherwise).
+ * Caller must own the bus until cb has run.
+ */
+int spi_bus_xfer_async(int ss, uint8_t *tx, uint8_t *rx, uint32_t len,
+                       spi_bus_cb_t cb, void *ctx);
+
+/*
+ * Split blocking transfer for pipelining: start, do other work, then wait.
+ * Task context only, caller must own the bus. A wait that times out
+ * aborts the transfer, so the buffers are free again once it returns.
+ */
+int spi_bus_xfer_start(int ss, uint8_t *tx, uint8_t *rx, uint32_t len);
+int spi_bus_xfer_wait(void);
+
+bool spi_bus_busy(void);
+
+// True when the caller is a task and may block on the DMA completion
+bool spi_bus_can_block(void);
+
+#endif // SPI_BUS_H
@@ -0,0 +1,203 @@
+#include "vibration_classifier.h"
+#include <string.h>
+#include "../utils/cycle_counter.h"
+
+/*
+ * ============================================================================
+ * Spectral vibration classifier (Q15)
+ * ============================================================================
+ * The FFT scratch buffers and Hann table are shared by every classifier
+ * instance: windows are only ever processed from MotionDetectionTask.
+ */
+
+#if (VIB_FFT_SIZE & (VIB_FFT_SIZE - 1)) || VIB_FFT_SIZE < 32 || VIB_FFT_SIZE > 8192
+#error "VIB_FFT_SIZE must be a power of two between 32 and 8192"
+#endif
+
+#if VIB_FFT_SIZE % MOTION_DSP_BLOCK_SIZE
+#error "VIB_FFT_SIZE must be a multiple of MOTION_DSP_BLOCK_SIZE"
+#endif
+
+#define MG_TO_Q15(mg) ((q15_t)(((int32_t)(mg) * 8192) / 1000))
+
+static const vib_band vib_bands[] = { VIB_BAND_TABLE };
+#define VIB_BAND_COUNT (sizeof(vib_bands) / sizeof(vib_bands[0]))
+
+#if defined(__GNUC__)
+_Static_assert(VIB_BAND_COUNT <= VIB_MAX_BANDS, "too many vibration bands");
+#endif
+
+static arm_rfft_instance_q15 rfft;
+static q15_t hann[VIB_FFT_SIZE];
+static q15_t fft_in[VIB_FFT_SIZE];
+static q15_t fft_out[2 * VIB_FFT_SIZE];
+static bool tables_ready = false;
+
+
+void vib_classifier_init(vib_classifier *vc)
+{
+    memset(vc, 0, sizeof(*vc));
+    cycle_counter_init();
+
+    if (tables_ready)
+        return;
+
+    // Forward real FFT, natural bin order
+    arm_rfft_init_q15(&rfft, VIB_FFT_SIZE, 0, 1);
+
+    // Hann window, computed once at start-up
+    for (uint32_t i = 0; i < VIB_FFT_SIZE; i++) {
+        float32_t w = 0.5f - 0.5f * arm_cos_f32(2.0f * PI * i / (VIB_FFT_SIZE - 1));
+        arm_float_to_q15(&w, &hann[i], 1);
+    }
+
+    tables_ready = true;
+}
+
+
+/***** Helpers *****/
+
+// Index of the axis with the most power in the collected window
+static uint32_t dominant_axis(const vib_classifier *vc, q63_t *power_out)
+{
+    uint32_t best = 0;
+    q63_t best_power = -1;
+
+    for (uint32_t a = 0; a < 3; a++) {
+        q63_t power;
+        arm_power_q15(vc->window[a], VIB_FFT_SIZE, &power);
+        if (power > best_power) {
+            best_power = power;
+            best = a;
+        }
+    }
+
+    *power_out = best_power;
+    return best;
+}
+
+// Left shift that brings the largest sample close to half scale
+static int8_t normalise_shift(const q15_t *x, uint32_t n)
+{
+    int32_t peak = 0;
+
+    for (uint32_t i = 0; i < n; i++) {
+        int32_t v = (x[i] < 0) ? -x[i] : x[i];
+        if (v > peak) peak = v;
+    }
+
+    int8_t shift = 0;
+    while (peak != 0 && peak < 0x2000 && shift < 14) {
+        peak <<= 1;
+        shift++;
+    }
+
+    return shift;
+}
+
+static uint32_t hz_to_bin(uint32_t hz, uint32_t odr_hz)
+{
+    uint32_t bin = (hz * VIB_FFT_SIZE) / odr_hz;
+    return (bin > VIB_FFT_SIZE / 2) ? VIB_FFT_SIZE / 2 : bin;
+}
+
+
+/***** Window classification *****/
+static void classify_window(vib_classifier *vc, uint32_t odr_hz)
+{
+    uint64_t band_power[VIB_MAX_BANDS] = {0};
+    uint64_t total = 0;
+    uint64_t peak_bin = 0;
+    q63_t axis_power;
+
+    uint32_t axis = dominant_axis(vc, &axis_power);
+
+    // Quiet check on the un-normalised window RMS (power is Q30 sum)
+    q31_t rms;
+    arm_sqrt_q31((q31_t)((axis_power / VIB_FFT_SIZE) << 1), &rms);
+    if ((q15_t)(rms >> 16) < MG_TO_Q15(VIB_QUIET_RMS_MG)) {
+        vc->last_class = VIB_QUIET;
+        return;
+    }
+
+    // Block floating point: scale up small signals so the FFT keeps precision
+    arm_shift_q15(vc->window[axis], normalise_shift(vc->window[axis], VIB_FFT_SIZE),
+                  fft_in, VIB_FFT_SIZE);
+    arm_mult_q15(fft_in, hann, fft_in, VIB_FFT_SIZE);
+
+    // fft_in is used as scratch by the transform
+    arm_rfft_q15(&rfft, fft_in, fft_out);
+
+    // Power per bin, skipping DC (bin 0) which the high-pass already removed
+    for (uint32_t b = 0; b < VIB_BAND_COUNT; b++) {
+        uint32_t lo = hz_to_bin(vib_bands[b].lo_hz, odr_hz);
+        uint32_t hi = hz_to_bin(vib_bands[b].hi_hz, odr_hz);
+        if (lo == 0) lo = 1;
+
+        for (uint32_t k = lo; k < hi; k++) {
+            int32_t re = fft_out[2 * k];
+            int32_t im = fft_out[2 * k + 1];
+            uint32_t p = (uint32_t)(re * re) + (uint32_t)(im * im);
+
+            band_power[b] += p;
+            total += p;
+            if (p > peak_bin) peak_bin = p;
+        }
+    }
+
+    if (total == 0) {
+        vc->last_class = VIB_QUIET;
+        return;
+    }
+
+    // Weighted score over band shares, minus the tonality penalty
+    int32_t score = 0;
+    for (uint32_t b = 0; b < VIB_BAND_COUNT; b++) {
+        vc->band_share[b] = (q15_t)((band_power[b] * 0x7FFF) / total);
+        score += (vib_bands[b].weight * vc->band_share[b]) >> 15;
+    }
+    vc->tonality = (q15_t)((peak_bin * 0x7FFF) / total);
+    score -= (VIB_TONALITY_WEIGHT * vc->tonality) >> 15;
+
+    vc->score = score;
+    if (score >= 0) {
+        vc->last_class = VIB_TAMPER;
+        vc->stats.tamper++;
+    } else {
+        vc->last_class = VIB_BACKGROUND;
+        vc->stats.background++;
+    }
+}
+
+
+bool vib_classifier_push(vib_classifier *vc,
+                         q15_t hp_axes[3][MOTION_DSP_BLOCK_SIZE],
+                         uint32_t odr_hz)
+{
+    for (uint32_t a = 0; a < 3; a++) {
+        memcpy(&vc->window[a][vc->fill], hp_axes[a],
+               MOTION_DSP_BLOCK_SIZE * sizeof(q15_t));
+    }
+    vc->fill += MOTION_DSP_BLOCK_SIZE;
+
+    if (vc->fill < VIB_FFT_SIZE)
+        return false;
+
+    vc->fill = 0;
+
+    uint32_t start = cycle_counter_now();
+    classify_window(vc, odr_hz);
+    uint32_t cycles = cycle_counter_now() - start;
+
+    vc->stats.windows++;
+    vc->stats.last_cycles = cycles;
+    if (cycles > vc->stats.max_cycles)
+        vc->stats.max_cycles = cycles;
+
+    return true;
+}
+
+vib_class vib_classifier_class(const vib_classifier *vc)
+{
+    return vc->last_class;
+}
@@ -0,0 +1,100 @@
+#ifndef VIBRATION_CLASSIFIER_H
+#define VIBRATION_CLASSIFIER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "arm_math.h"
+#include "motion_dsp.h"
+
+/*
+ * Spectral vibration classifier.
+ *
+ * Collects high-passed samples from the shake pipeline into windows of
+ * VIB_FFT_SIZE, runs a Hann-windowed real FFT (arm_rfft_q15) on the
+ * dominant axis and sums the power spectrum into frequency bands.
+ * A constant weight table then separates periodic building vibration
+ * (escalators, HVAC plant: tonal, 15-100 Hz) from human tampering
+ * (broadband, mostly below 15 Hz).
+ *
+ * Both the FFT size and the band layout are compile-time settings.
+ * Override them before this header is included (e.g. in project.mk).
+ */
+
+#ifndef VIB_FFT_SIZE
+#define VIB_FFT_SIZE 256 // Any arm_rfft_q15 length: 32..8192, power of two
+#endif
+
+/*
+ * Band layout: { low Hz (inclusive), high Hz (exclusive), weight }.
+ * Weights are Q8 (256 = 1.0): positive bands vote for tampering,
+ * negative bands for background vibration.
+ */
+#ifndef VIB_BAND_TABLE
+#define VIB_BAND_TABLE                                            \
+    {   0,   6,  256 },  /* Lifting, pushing, body movement */    \
+    {   6,  15,  128 },  /* Handling, tapping */                  \
+    {  15,  40, -192 },  /* Escalator drives, fans */             \
+    {  40, 100, -256 },  /* Motors, compressors */                \
+    { 100, 400,  -64 }   /* Structure-borne noise */
+#endif
+
+// Penalty (Q8) applied to the share of power in the single strongest bin
+#ifndef VIB_TONALITY_WEIGHT
+#define VIB_TONALITY_WEIGHT 256
+#endif
+
+// Below this window RMS (milli-g) the window is simply quiet
+#ifndef VIB_QUIET_RMS_MG
+#define VIB_QUIET_RMS_MG 20
+#endif
+
+#define VIB_MAX_BANDS 8
+
+typedef enum vib_class {
+    VIB_QUIET = 0,   // Nothing worth classifying
+    VIB_BACKGROUND,  // Periodic building / plant vibration
+    VIB_TAMPER       // Broadband low-frequency handling
+} vib_class;
+
+typedef struct vib_band {
+    uint16_t lo_hz;
+    uint16_t hi_hz;
+    int16_t weight;
+} vib_band;
+
+typedef struct vib_stats {
+    uint32_t windows;         // Windows classified
+    uint32_t last_cycles;     // Cost of the most recent window
+    uint32_t max_cycles;      // Worst window so far
+    uint32_t background;      // Windows classified as background
+    uint32_t tamper;          // Windows classified as tampering
+    uint32_t suppressed;      // Events held back while in background
+} vib_stats;
+
+// Classifier state (one per sensor)
+typedef struct vib_classifier {
+    q15_t window[3][VIB_FFT_SIZE];   // High-passed X/Y/Z being collected
+    uint32_t fill;
+    vib_class last_class;
+    q15_t band_share[VIB_MAX_BANDS]; // Share of power per band (Q15)
+    q15_t tonality;                  // Share of power in the peak bin (Q15)
+    int32_t score;                   // Last weighted score (Q8)
+    vib_stats stats;
+} vib_classifier;
+
+// Reset state and prepare the FFT instance / window table
+void vib_classifier_init(vib_classifier *vc);
+
+/*
+ * Append one block of high-passed samples.
+ * Returns true when a window completed and the class was updated.
+ * odr_hz is the current sensor output data rate, used to map bands to bins.
+ */
+bool vib_classifier_push(vib_classifier *vc,
+                         q15_t hp_axes[3][MOTION_DSP_BLOCK_SIZE],
+                         uint32_t odr_hz);
+
+// Class of the most recently completed window
+vib_class vib_classifier_class(const vib_classifier *vc);
+
+#endif /* VIBRATION_CLASSIFIER_H */
@@ -13,7 +13,6 @@
  *
  */
 
-#include <stdio.h>
 #include <string.h>
 #include <stdbool.h>
 #include "FreeRTOS.h"
@@ -24,184 +23,782 @@
 #include "../utils/typing.h"
 #include "../utils/queues.h"
 #include "uart_coms.h"
+#include "crc16.h"
+#include "../motion/adxl343_motion.h"
+#include "../utils/flash_log.h"
+#include "../utils/cloud_buffer.h"
+#include "../utils/event_bus.h"
+#include "../utils/task_signal.h"
+#include "../utils/low_power.h"
+#include "../utils/spsc_ring.h"
 #include "board.h"
 #include "mxc_device.h"
 #include "uart.h"
+#include "trng.h"
 
 // Configuration constants
 #define TX_TIMEOUT_MS 100
 #define ACK_TIMEOUT_MS 200
-#define ACK_BYTE 0xAA
-#define INTER_MESSAGE_DELAY_MS 50
 #define RETRY_BACKOFF_MS 500
+#define IDLE_POLL_MS 100
 
-// Binary semaphore for ACK reception (signaled by UART ISR)
-static SemaphoreHandle_t ack_semaphore = NULL;
+/*
+ * Transmit window: up to CLOUD_TX_WINDOW updates can be in flight.
+ * Every frame starts with a header byte [SYN:1][seq:7]; the gateway
+ * answers with a cumulative sequence number plus an 8-bit selective ACK
+ * bitmap, so the window can't be wider than 8 frames.
+ */
+#define CLOUD_TX_WINDOW 4
+#define CLOUD_SEQ_MASK  0x7F
+#define CLOUD_HDR_SYN   0x80  // First frame of a session - gateway resyncs
+#define CLOUD_SACK_BITS 8
+
+/*
+ * Binary cloud update message (see encode_cloud_update). The first byte
+ * carries the message type and layout version so the gateway can reject
+ * or adapt to layouts it does not know.
+ */
+#define CLOUD_MSG_VERSION     1
+#define CLOUD_MSG_UPDATE      1
+#define CLOUD_MSG_UPDATE_LEN  12
+#define CLOUD_MSG_FLAG_MOTION 0x01
+#define CLOUD_MSG_NO_WARN     0xFF
+
+// Batch of update messages sharing one frame, CRC and ACK
+#define CLOUD_MSG_BATCH         2
+#define CLOUD_MSG_BATCH_HDR_LEN 2
+#define CLOUD_BATCH_MAX ((UART_MAX_DATA_LENGTH - 1 - CLOUD_MSG_BATCH_HDR_LEN) / CLOUD_MSG_UPDATE_LEN)
+
+// Session start: frame size negotiation (see window_push_hello)
+#define CLOUD_MSG_HELLO         3
+#define CLOUD_MSG_HELLO_LEN     8
+
+// Loss counters (see window_push_diag)
+#define CLOUD_MSG_DIAG          4
+#define CLOUD_DIAG_COUNTERS     6
+#define CLOUD_MSG_DIAG_LEN      (1 + 2 * CLOUD_DIAG_COUNTERS)
+#define DIAG_INTERVAL_MS        10000
+
+// Subsystem statistics, one section per frame (see window_push_report)
+#define CLOUD_MSG_REPORT        5
+#define CLOUD_REPORT_HDR_LEN    2
+#define CLOUD_REPORT_MAX        (UART_MAX_DATA_LENGTH - 1 - CLOUD_REPORT_HDR_LEN)
+#define REPORT_INTERVAL_MS      60000
+#define REPORT_RINGS_MAX        8
+
+// Report section ids, sent in this order (gateway: REPORT_SECTIONS)
+enum {
+    REPORT_SECTION_DSP = 0,     // Shake pipeline cycle cost, per sensor
+    REPORT_SECTION_VIB,         // Vibration classifier, per sensor
+    REPORT_SECTION_LOW_POWER,   // Sleep residency per alarm state, wake latency
+    REPORT_SECTION_UART_RX,     // UART0 RX interrupt and framing counters
+    REPORT_SECTION_CRC,         // CRC-16 implementation cycle counts
+    REPORT_SECTION_UART_TX,     // UART0 TX framing goodput
+    REPORT_SECTION_RINGS,       // Lock-free ISR -> task rings
+    REPORT_SECTION_COUNT
+};
+
+#if CLOUD_TX_WINDOW > CLOUD_SACK_BITS
+#error "CLOUD_TX_WINDOW must fit the selective ACK bitmap"
+#endif
+
+typedef struct {
+    uint8_t cum;   // Next sequence number the gateway expects
+    uint8_t sack;  // bit i: frame cum + 1 + i already received
+} cloud_ack;
+
+typedef struct {
+    uint8_t frame[UART_MAX_DATA_LENGTH];  // Header + update or batch message
+    uint8_t length;
+    bool acked;                           // Selectively acknowledged
+    uint8_t retries;
+    TickType_t sent_tick;
+} cloud_tx_slot;
+
+// Latest ACK decoded by the UART link task, [sack << 8 | cum], stored in
+// one halfword write; signalled to cloud_task with TASK_SIGNAL_ACK
+static volatile uint16_t latest_ack = 0;
+static TaskHandle_t cloud_task = NULL;
+
+// In-flight frames, oldest first: slot (tx_base + i) holds seq base_seq + i
+static cloud_tx_slot tx_window[CLOUD_TX_WINDOW];
+static uint8_t tx_base = 0;
+static uint8_t tx_count = 0;
+static uint8_t base_seq = 0;
+static uint8_t next_seq = 0;
+static bool syn_pending = true;  // Session start not yet acknowledged
+static uint32_t session_nonce = 0;  // Random per boot, carried in the HELLO
+
+// Counts every update handed to the gateway (wraps at 16 bits)
+static uint16_t update_seq = 0;
+
+// Loss counters as last reported to the gateway
+static uint16_t diag_sent[CLOUD_DIAG_COUNTERS];
+static TickType_t diag_tick = 0;
+
+// Next report section to send; 0 = cycle done, wait for REPORT_INTERVAL_MS
+static uint8_t report_next = 0;
+static TickType_t report_tick = 0;
 
 /**
- * @brief UART RX callback - sends command to queue from ISR context
+ * @brief UART RX callback - publishes command to the event bus from the link task
  */
-void on_message_received(command_type cmd) {
-    command_event event;
-    event.cmd = cmd;
+void on_message_received(command_type cmd, uint8_t arg) {
+    // Sensor profile changes go straight to the motion task
+    if (cmd == SET_PROFILE) {
+        adxl343_motion_request_profile((motion_profile)arg);
+        return;
+    }
 
-    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    alert_event event = {
+        .source = EVENT_SOURCE_COMMAND,
+        .timestamp = xTaskGetTickCount(),
+        .command = {.cmd = cmd, .arg = arg}
+    };
 
-    // Attempt to send to queue
-    if (xQueueSendFromISR(command_queue, &event, &xHigherPriorityTaskWoken) != pdPASS) {
-        // Queue full - drop oldest command to make room
-        command_event discarded_event;
-        xQueueReceiveFromISR(command_queue, &discarded_event, &xHigherPriorityTaskWoken);
+    // Never blocks the link task; operator commands outrank anything they
+    // could be dropped for, so they only fail on a bus full of commands
+    event_bus_publish(&event);
+}
+
+/**
+ * @brief Store little-endian integers into the message buffer
+ */
+static void put_le16(uint8_t* p, uint16_t v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+}
+
+static void put_le32(uint8_t* p, uint32_t v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = (v >> 24) & 0xFF;
+}
+
+static void put_le64(uint8_t* p, uint64_t v) {
+    put_le32(p, (uint32_t)v);
+    put_le32(&p[4], (uint32_t)(v >> 32));
+}
 
-        // Retry sending new command (should succeed now)
-        xQueueSendFromISR(command_queue, &event, &xHigherPriorityTaskWoken);
+/**
+ * @brief Encode cloud_update_event as a fixed-layout binary message
+ *
+ * Layout (CLOUD_MSG_UPDATE_LEN bytes, little-endian, gateway: "<BBBBBBHI"):
+ *   [0]    type << 4 | version   (CLOUD_MSG_UPDATE, CLOUD_MSG_VERSION)
+ *   [1]    flags                 (bit 0: from_motion)
+ *   [2]    warn_type             (CLOUD_MSG_NO_WARN for command updates)
+ *   [3]    alarm_state
+ *   [4]    ODR code              (Hz = 3200 / 2^(15 - code))
+ *   [5]    device_id             (source sensor, motion updates only)
+ *   [6:7]  update sequence number
+ *   [8:11] device timestamp, RTOS tick (ms)
+ *
+ * @param update Pointer to cloud_update_event
+ * @param seq Update sequence number
+ * @param buffer Output buffer
+ * @param buffer_size Size of output buffer
+ * @return Number of bytes written, or -1 if the buffer is too small
+ */
+static int encode_cloud_update(const cloud_update_event* update,
+                               uint16_t seq,
+                               uint8_t* buffer,
+                               size_t buffer_size) {
+    if (buffer_size < CLOUD_MSG_UPDATE_LEN) {
+        return -1;
     }
 
-    // Yield to higher priority task if necessary
-    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+    buffer[0] = (CLOUD_MSG_UPDATE << 4) | CLOUD_MSG_VERSION;
+    buffer[1] = update->from_motion ? CLOUD_MSG_FLAG_MOTION : 0;
+    buffer[2] = update->from_motion ? (uint8_t)update->warning : CLOUD_MSG_NO_WARN;
+    buffer[3] = (uint8_t)update->state;
+    buffer[4] = update->odr_code & 0x0F;
+    buffer[5] = update->from_motion ? update->device_id : 0;
+    put_le16(&buffer[6], seq);
+    put_le32(&buffer[8], update->timestamp);
+
+    return CLOUD_MSG_UPDATE_LEN;
 }
 
 /**
- * @brief Convert warn_type enum to abbreviated string
+ * @brief Called by the UART link task when a window ACK is received
  */
-static const char* warn_type_to_string(warn_type warning) {
-    switch (warning) {
-        case LOW_WARN:  return "LOW";
-        case MED_WARN:  return "MED";
-        case HIGH_WARN: return "HIGH";
-        default:        return "UNK";
+void on_ack_received(uint8_t cum, uint8_t sack) {
+    if (cloud_task != NULL) {
+        // Each ACK carries the gateway's whole receive state, so a later
+        // one supersedes any the cloud task has not looked at yet
+        latest_ack = (uint16_t)((cum & CLOUD_SEQ_MASK) | (sack << 8));
+        task_signal_raise(cloud_task, TASK_SIGNAL_ACK);
     }
 }
 
 /**
- * @brief Convert alarm_state enum to string
+ * @brief Called by the UART link task when the gateway requests a resync
+ */
+void on_resync_requested(void) {
+    task_signal_raise(cloud_task, TASK_SIGNAL_RESYNC);
+}
+
+/**
+ * @brief Distance from b forward to a in sequence space
  */
-static const char* alarm_state_to_string(alarm_state state) {
-    switch (state) {
-        case DISARMED:    return "DISARMED";
-        case ARMED_IDLE:  return "ARMED";
-        case WARN:        return "WARN";
-        case ALERT:       return "ALERT";
-        case ALARM:       return "ALARM";
-        default:          return "UNKNOWN";
+static uint8_t seq_diff(uint8_t a, uint8_t b) {
+    return (a - b) & CLOUD_SEQ_MASK;
+}
+
+static cloud_tx_slot* window_slot(uint8_t i) {
+    return &tx_window[(tx_base + i) % CLOUD_TX_WINDOW];
+}
+
+/**
+ * @brief Transmit (or retransmit) one window slot
+ */
+static void send_slot(cloud_tx_slot* slot) {
+    // A frame that failed to drain is simply retried on its timeout
+    uart_send_frame_with_timeout(slot->frame, slot->length, TX_TIMEOUT_MS);
+    slot->sent_tick = xTaskGetTickCount();
+}
+
+/**
+ * @brief Release cumulatively acknowledged frames and mark selective ACKs
+ */
+static void apply_ack(const cloud_ack* ack) {
+    uint8_t done = seq_diff(ack->cum, base_seq);
+
+    // Ignore stale ACKs that point before or beyond the window
+    if (done > tx_count) {
+        return;
+    }
+
+    if (done > 0) {
+        tx_base = (tx_base + done) % CLOUD_TX_WINDOW;
+        tx_count -= done;
+        base_seq = ack->cum;
+        syn_pending = false;
+    }
+
+    // Frames after the gap that the gateway holds right now. Each ACK
+    // carries its whole state, so a bit that went away (gateway restarted)
+    // puts the frame back on the normal retransmit schedule.
+    for (uint8_t i = 1; i < tx_count; i++) {
+        window_slot(i)->acked = (ack->sack & (1u << (i - 1))) != 0;
     }
 }
 
 /**
- * @brief Serialize cloud_update_event to pipe-delimited format
+ * @brief Restart the gateway's window from our oldest unacknowledged frame
  *
- * Format: FROM_MOTION|WARN_TYPE|ALARM_STATE
- * - Motion event: "1|HIGH|WARN"
- * - Command event: "0||DISARMED" (warn_type empty)
+ * The gateway lost its state (restarted mid-session) and will not ACK
+ * frames it has no base for. The oldest in-flight frame is marked SYN and
+ * everything in flight is resent in order; no new frames go out until the
+ * gateway ACKs it. With nothing in flight the next frame carries SYN.
+ */
+static void window_resync(void) {
+    syn_pending = true;
+
+    for (uint8_t i = 0; i < tx_count; i++) {
+        cloud_tx_slot* slot = window_slot(i);
+        if (i == 0) {
+            slot->frame[0] |= CLOUD_HDR_SYN;
+        }
+        slot->acked = false;
+        slot->retries = 0;
+        send_slot(slot);
+    }
+}
+
+/**
+ * @brief Assign the next sequence number to a filled slot and send it
  *
- * @param update Pointer to cloud_update_event
- * @param buffer Output buffer
- * @param buffer_size Size of output buffer
- * @return Number of bytes written (excluding null terminator), or -1 on error
+ * @param len Message length (excluding the window header byte)
  */
-static int serialize_cloud_update(const cloud_update_event* update,
-                                  char* buffer,
-                                  size_t buffer_size) {
-    int len;
+static void window_commit(cloud_tx_slot* slot, int len) {
+    slot->frame[0] = next_seq | (syn_pending && tx_count == 0 ? CLOUD_HDR_SYN : 0);
+    slot->length = (uint8_t)(len + 1);
+    slot->acked = false;
+    slot->retries = 0;
 
-    if (update->from_motion) {
-        // Motion event - include warn_type
-        len = snprintf(buffer, buffer_size,
-                       "%u|%s|%s",
-                       update->from_motion,
-                       warn_type_to_string(update->warning),
-                       alarm_state_to_string(update->state));
-    } else {
-        // Command event - warn_type is null (empty field)
-        len = snprintf(buffer, buffer_size,
-                       "%u||%s",
-                       update->from_motion,
-                       alarm_state_to_string(update->state));
+    tx_count++;
+    next_seq = (next_seq + 1) & CLOUD_SEQ_MASK;
+
+    send_slot(slot);
+}
+
+/**
+ * @brief Queue the session's HELLO message
+ *
+ * Layout: [type << 4 | version][rx_max_low][rx_max_high][link_caps][nonce u32]
+ * rx_max is the largest (extended) frame payload this board accepts,
+ * link_caps the optional framings it speaks (UART_LINK_CAP_*).
+ * The nonce tells a rebooted board's HELLO apart from a retransmission of
+ * the previous one even if both start on the same sequence number.
+ * The gateway answers with a "HELLO:<n>[:COBS]" frame, handled by the UART link.
+ */
+static void window_push_hello(void) {
+    cloud_tx_slot* slot = window_slot(tx_count);
+    uint8_t* msg = &slot->frame[1];
+
+    msg[0] = (CLOUD_MSG_HELLO << 4) | CLOUD_MSG_VERSION;
+    put_le16(&msg[1], UART_EXT_MAX_DATA_LENGTH);
+    msg[3] = UART_LINK_CAPS;
+    put_le32(&msg[4], session_nonce);
+
+    window_commit(slot, CLOUD_MSG_HELLO_LEN);
+}
+
+/**
+ * @brief Report update loss counters when they have changed
+ *
+ * Layout: [type << 4 | version] then six u16 counters (wrapping):
+ *   collapsed, evicted, dropped, critical_drops  (cloud buffer)
+ *   spill_drops, overwritten                     (flash log)
+ * critical_drops also counts ALERT/ALARM updates lost to spill_drops.
+ * Sent at most every DIAG_INTERVAL_MS, so a burst of losses costs one frame.
+ *
+ * @return true if a frame was queued and sent
+ */
+static bool window_push_diag(void) {
+    if (xTaskGetTickCount() - diag_tick < pdMS_TO_TICKS(DIAG_INTERVAL_MS)) {
+        return false;
+    }
+
+    cloud_buffer_stats buffer;
+    flash_log_stats log;
+    cloud_buffer_get_stats(&buffer);
+    flash_log_get_stats(&log);
+
+    uint16_t counters[CLOUD_DIAG_COUNTERS] = {
+        buffer.collapsed, buffer.evicted, buffer.dropped,
+        buffer.critical_drops + log.critical_spill_drops,
+        log.spill_drops, log.overwritten
+    };
+
+    if (memcmp(counters, diag_sent, sizeof(counters)) == 0) {
+        return false;
+    }
+
+    cloud_tx_slot* slot = window_slot(tx_count);
+    uint8_t* msg = &slot->frame[1];
+
+    msg[0] = (CLOUD_MSG_DIAG << 4) | CLOUD_MSG_VERSION;
+    for (uint8_t i = 0; i < CLOUD_DIAG_COUNTERS; i++) {
+        put_le16(&msg[1 + 2 * i], counters[i]);
+    }
+
+    window_commit(slot, CLOUD_MSG_DIAG_LEN);
+
+    memcpy(diag_sent, counters, sizeof(diag_sent));
+    diag_tick = xTaskGetTickCount();
+    return true;
+}
+
+/**
+ * @brief Report section: shake pipeline cycle cost
+ *
+ * Per fitted sensor: [device] then u32 blocks, last_cycles, max_cycles,
+ * over_budget.
+ *
+ * @return Payload length, 0 if there is nothing to report
+ */
+static int report_dsp(uint8_t* out, int max) {
+    const int entry = 1 + 4 * 4;
+    motion_dsp_stats stats;
+    int len = 0;
+
+    for (uint8_t i = 0; i < MOTION_MAX_SENSORS && len + entry <= max; i++) {
+        if (adxl343_motion_get_dsp_stats(i, &stats) != 0) {
+            continue;
+        }
+        out[len] = i;
+        put_le32(&out[len + 1], stats.blocks);
+        put_le32(&out[len + 5], stats.last_cycles);
+        put_le32(&out[len + 9], stats.max_cycles);
+        put_le32(&out[len + 13], stats.over_budget);
+        len += entry;
+    }
+    return len;
+}
+
+/**
+ * @brief Report section: vibration classifier
+ *
+ * Per fitted sensor: [device] then u32 windows, last_cycles, max_cycles,
+ * background, tamper, suppressed.
+ */
+static int report_vib(uint8_t* out, int max) {
+    const int entry = 1 + 6 * 4;
+    vib_stats stats;
+    int len = 0;
+
+    for (uint8_t i = 0; i < MOTION_MAX_SENSORS && len + entry <= max; i++) {
+        if (adxl343_motion_get_vib_stats(i, &stats) != 0) {
+            continue;
+        }
+        out[len] = i;
+        put_le32(&out[len + 1], stats.windows);
+        put_le32(&out[len + 5], stats.last_cycles);
+        put_le32(&out[len + 9], stats.max_cycles);
+        put_le32(&out[len + 13], stats.background);
+        put_le32(&out[len + 17], stats.tamper);
+        put_le32(&out[len + 21], stats.suppressed);
+        len += entry;
     }
+    return len;
+}
 
-    if (len < 0 || len >= (int)buffer_size) {
-        return -1;  // Error or buffer overflow
+/**
+ * @brief Report section: tickless idle residency
+ *
+ * u32 last_wake_to_event_us, max_wake_to_event_us, then per alarm state
+ * (DISARMED..ALARM): u64 total_us, u64 sleep_us, u32 sleeps.
+ */
+static int report_low_power(uint8_t* out, int max) {
+    const int entry = 8 + 8 + 4;
+    low_power_stats stats;
+    int len = 8;
+
+    if (len + (ALARM + 1) * entry > max) {
+        return 0;
     }
 
+    low_power_get_stats(&stats);
+    put_le32(&out[0], stats.last_wake_to_event_us);
+    put_le32(&out[4], stats.max_wake_to_event_us);
+    for (uint8_t i = 0; i <= ALARM; i++) {
+        put_le64(&out[len], stats.state[i].total_us);
+        put_le64(&out[len + 8], stats.state[i].sleep_us);
+        put_le32(&out[len + 16], stats.state[i].sleeps);
+        len += entry;
+    }
     return len;
 }
 
 /**
- * @brief Called by UART ISR when ACK byte (0xAA) is received
+ * @brief Report section: UART0 receive path
+ *
+ * u32 isr_entries, rx_entries, timeout_entries, rx_bytes, max_batch,
+ * overruns, dropped, ext_alloc_failures, cobs_errors.
  */
-void on_ack_received(void) {
-    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-    xSemaphoreGiveFromISR(ack_semaphore, &xHigherPriorityTaskWoken);
-    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+static int report_uart_rx(uint8_t* out, int max) {
+    uart_rx_stats stats;
+    uart_get_rx_stats(&stats);
+
+    const uint32_t counters[] = {
+        stats.isr_entries, stats.rx_entries, stats.timeout_entries,
+        stats.rx_bytes, stats.max_batch, stats.overruns, stats.dropped,
+        stats.ext_alloc_failures, stats.cobs_errors
+    };
+    int len = 0;
+
+    for (uint8_t i = 0; i < sizeof(counters) / sizeof(counters[0]) && len + 4 <= max; i++) {
+        put_le32(&out[len], counters[i]);
+        len += 4;
+    }
+    return len;
 }
 
 /**
- * @brief Wait for ACK byte from gateway with timeout
- * @return true if ACK received, false if timeout
+ * @brief Report section: CRC-16 benchmark
+ *
+ * u32 bytes, cycles per implementation (bytewise, slice4, slice8, hw),
+ * mismatches, then u8 hw_available. The benchmark runs once, on the
+ * first report.
  */
-static bool wait_for_ack(uint32_t timeout_ms) {
-    // Clear any stale ACKs first
-    xSemaphoreTake(ack_semaphore, 0);
+static int report_crc(uint8_t* out, int max) {
+    static crc16_bench bench;
+    static bool measured = false;
+    int len = 0;
 
-    // Wait for ACK with timeout
-    return xSemaphoreTake(ack_semaphore, pdMS_TO_TICKS(timeout_ms)) == pdPASS;
+    if (4 + 4 * CRC16_IMPL_COUNT + 4 + 1 > max) {
+        return 0;
+    }
+    if (!measured) {
+        crc16_benchmark(&bench);
+        measured = true;
+    }
+
+    put_le32(&out[len], bench.bytes);
+    len += 4;
+    for (uint8_t i = 0; i < CRC16_IMPL_COUNT; i++) {
+        put_le32(&out[len], bench.cycles[i]);
+        len += 4;
+    }
+    put_le32(&out[len], bench.mismatches);
+    len += 4;
+    out[len++] = (uint8_t)crc16_hw_available();
+    return len;
 }
 
 /**
- * @brief Cloud send task - processes cloud_update_queue and handles transmission
+ * @brief Report section: UART0 transmit framing
  *
- * Transmits cloud update events via UART with ACK-based confirmation.
- * Implements retry logic with automatic reconnection:
- * - Messages remain in queue until ACK received
- * - Retries failed messages with backoff
- * - Automatically drains queue when gateway reconnects
+ * u32 frames, cobs_frames, payload_bytes, wire_bytes.
+ */
+static int report_uart_tx(uint8_t* out, int max) {
+    uart_tx_stats stats;
+
+    if (4 * 4 > max) {
+        return 0;
+    }
+
+    uart_get_tx_stats(&stats);
+    put_le32(&out[0], stats.frames);
+    put_le32(&out[4], stats.cobs_frames);
+    put_le32(&out[8], stats.payload_bytes);
+    put_le32(&out[12], stats.wire_bytes);
+    return 4 * 4;
+}
+
+/**
+ * @brief Report section: SPSC rings
  *
+ * Per registered ring: [name_len][name] then u16 capacity and u32 count,
+ * pushed, drops, high_water.
  */
-void cloud_send_task(void *pvParameters) {
+static int report_rings(uint8_t* out, int max) {
+    spsc_ring_stats rings[REPORT_RINGS_MAX];
+    uint8_t n = spsc_ring_get_diag(rings, REPORT_RINGS_MAX);
+    int len = 0;
+
+    for (uint8_t i = 0; i < n; i++) {
+        size_t name_len = strnlen(rings[i].name, 32);
+        if (len + 1 + (int)name_len + 2 + 4 * 4 > max) {
+            break;
+        }
+
+        out[len++] = (uint8_t)name_len;
+        memcpy(&out[len], rings[i].name, name_len);
+        len += name_len;
+        put_le16(&out[len], (uint16_t)rings[i].capacity);
+        put_le32(&out[len + 2], rings[i].count);
+        put_le32(&out[len + 6], rings[i].pushed);
+        put_le32(&out[len + 10], rings[i].drops);
+        put_le32(&out[len + 14], rings[i].high_water);
+        len += 2 + 4 * 4;
+    }
+    return len;
+}
+
+// Indexed by section id
+static int (* const report_sections[REPORT_SECTION_COUNT])(uint8_t* out, int max) = {
+    [REPORT_SECTION_DSP] = report_dsp,
+    [REPORT_SECTION_VIB] = report_vib,
+    [REPORT_SECTION_LOW_POWER] = report_low_power,
+    [REPORT_SECTION_UART_RX] = report_uart_rx,
+    [REPORT_SECTION_CRC] = report_crc,
+    [REPORT_SECTION_UART_TX] = report_uart_tx,
+    [REPORT_SECTION_RINGS] = report_rings,
+};
+
+/**
+ * @brief Send the next subsystem statistics section
+ *
+ * Layout: [type << 4 | version][section id][section payload]
+ * Every REPORT_INTERVAL_MS one cycle goes out through all sections, one
+ * frame each, only while no updates are waiting so reports never hold
+ * back an alarm. Sections with nothing to report are skipped.
+ *
+ * @return true if a frame was queued and sent
+ */
+static bool window_push_report(void) {
+    if (report_next == 0) {
+        if (xTaskGetTickCount() - report_tick < pdMS_TO_TICKS(REPORT_INTERVAL_MS)) {
+            return false;
+        }
+        report_tick = xTaskGetTickCount();
+    }
+
+    cloud_tx_slot* slot = window_slot(tx_count);
+    uint8_t* msg = &slot->frame[1];
+    int len = 0;
+
+    while (len == 0 && report_next < REPORT_SECTION_COUNT) {
+        msg[1] = report_next;
+        len = report_sections[report_next++](&msg[CLOUD_REPORT_HDR_LEN], CLOUD_REPORT_MAX);
+    }
+    if (report_next == REPORT_SECTION_COUNT) {
+        report_next = 0;
+    }
+    if (len == 0) {
+        return false;
+    }
+
+    msg[0] = (CLOUD_MSG_REPORT << 4) | CLOUD_MSG_VERSION;
+    window_commit(slot, CLOUD_REPORT_HDR_LEN + len);
+    return true;
+}
+
+/**
+ * @brief Take the oldest pending update
+ *
+ * Updates still in the cloud buffer were produced before anything in
+ * the flash log (AlertControlTask keeps spilling until the log is empty),
+ * so the queue is drained first.
+ */
+static bool next_update(cloud_update_event* update, TickType_t wait) {
+    if (cloud_buffer_pop(update, 0)) {
+        return true;
+    }
+    if (flash_log_read(update)) {
+        return true;
+    }
+    return wait != 0 && cloud_buffer_pop(update, wait);
+}
+
+static bool updates_waiting(void) {
+    return cloud_buffer_count() != 0 || flash_log_readable() != 0;
+}
+
+/**
+ * @brief Pull queued updates into a fresh window slot
+ *
+ * A single waiting update goes out as a plain update message. If the
+ * queue has backed up (gateway offline, window full) every update that
+ * fits is packed into one batch message instead (the same goes for
+ * updates replayed from the flash log):
+ *   [type << 4 | version][count][update message] x count
+ *
+ * @return true if a frame was queued and sent
+ */
+static bool window_push(TickType_t wait) {
     cloud_update_event update;
-    char buffer[16 + 1];  // MAX_DATA_LENGTH + null terminator
 
-    // Create ACK semaphore
-    ack_semaphore = xSemaphoreCreateBinary();
+    if (!next_update(&update, wait)) {
+        return false;
+    }
+
+    cloud_tx_slot* slot = window_slot(tx_count);
+    uint8_t* msg = &slot->frame[1];  // After the window header byte
+    int len;
 
-    while (1) {
-        // Check if we have messages to send
-        if (xQueuePeek(cloud_update_queue, &update, pdMS_TO_TICKS(100)) == pdPASS) {
+    if (!updates_waiting()) {
+        len = encode_cloud_update(&update, update_seq++, msg, sizeof(slot->frame) - 1);
+        if (len < 0) {
+            return true;  // Encoding failed - discard this message
+        }
+    } else {
+        uint8_t count = 0;
+        len = CLOUD_MSG_BATCH_HDR_LEN;
 
-            // Serialize to pipe-delimited format
-            int len = serialize_cloud_update(&update, buffer, sizeof(buffer));
+        while (1) {
+            len += encode_cloud_update(&update, update_seq++, &msg[len], CLOUD_MSG_UPDATE_LEN);
+            count++;
 
-            if (len < 0) {
-                // Serialization failed - discard this message
-                xQueueReceive(cloud_update_queue, &update, 0);
-                continue;
+            // Stop when the next update would not fit or the queue is empty
+            if (count == CLOUD_BATCH_MAX ||
+                !next_update(&update, 0)) {
+                break;
             }
+        }
+
+        msg[0] = (CLOUD_MSG_BATCH << 4) | CLOUD_MSG_VERSION;
+        msg[1] = count;
+    }
+
+    window_commit(slot, len);
+    return true;
+}
+
+/**
+ * @brief Resend unacknowledged frames whose ACK timeout has expired
+ * @return Ticks until the next retransmit deadline (or IDLE_POLL_MS)
+ */
+static TickType_t window_retransmit(void) {
+    TickType_t now = xTaskGetTickCount();
+    TickType_t next = pdMS_TO_TICKS(IDLE_POLL_MS);
 
-            // Attempt transmission with timeout
-            int result = uart_send_frame_with_timeout(
-                (const uint8_t*)buffer,
-                (uint8_t)len,
-                TX_TIMEOUT_MS
-            );
-
-            if (result != 0) {
-                // TX failed (FIFO full) - gateway offline, retry
-                vTaskDelay(pdMS_TO_TICKS(RETRY_BACKOFF_MS));
-                continue;
+    for (uint8_t i = 0; i < tx_count; i++) {
+        cloud_tx_slot* slot = window_slot(i);
+
+        // First retry after ACK_TIMEOUT_MS, then back off while the gateway
+        // is away. A selective ACK only defers the resend: the gateway keeps
+        // it in memory, and a frame stuck behind a gap is resent until the
+        // cumulative ACK passes it.
+        TickType_t timeout = pdMS_TO_TICKS(slot->retries || slot->acked ? RETRY_BACKOFF_MS
+                                                                        : ACK_TIMEOUT_MS);
+        TickType_t elapsed = now - slot->sent_tick;
+
+        if (elapsed >= timeout) {
+            if (slot->retries < UINT8_MAX) {
+                slot->retries++;
             }
+            send_slot(slot);
+            elapsed = 0;
+            timeout = pdMS_TO_TICKS(RETRY_BACKOFF_MS);
+        }
 
-            // TX succeeded - now wait for ACK from gateway
-            if (wait_for_ack(ACK_TIMEOUT_MS)) {
-                // ACK received - message confirmed delivered
-                xQueueReceive(cloud_update_queue, &update, 0);
+        if (timeout - elapsed < next) {
+            next = timeout - elapsed;
+        }
+    }
 
-                // Inter-message delay to avoid overwhelming gateway during queue drain
-                vTaskDelay(pdMS_TO_TICKS(INTER_MESSAGE_DELAY_MS));
+    return next;
+}
 
-            } else {
-                // No ACK - gateway offline, retry after backoff
-                vTaskDelay(pdMS_TO_TICKS(RETRY_BACKOFF_MS));
+/**
+ * @brief Cloud send task - processes the cloud buffer and handles transmission
+ *
+ * Transmits cloud update events via UART with a sliding window:
+ * - Up to CLOUD_TX_WINDOW frames in flight, each with a sequence number
+ * - Cumulative + selective ACKs from the gateway release frames
+ * - Frames still missing are resent on timeout, selectively ACKed ones
+ *   only after RETRY_BACKOFF_MS
+ * - A gateway that restarted mid-session asks for a resync; the window is
+ *   resent from its oldest frame, marked SYN
+ * - Backs off to RETRY_BACKOFF_MS while the gateway is offline and drains
+ *   the queue when it reconnects
+ * - The first frame of a session is a HELLO carrying SYN, sent alone, so
+ *   the gateway can resync after either side restarts and learn how large
+ *   a frame this board accepts
+ * - Reports dropped/evicted update counters in a DIAG frame when they change
+ * - Reports subsystem statistics in REPORT frames every REPORT_INTERVAL_MS
+ */
+void cloud_send_task(void *pvParameters) {
+    cloud_task = xTaskGetCurrentTaskHandle();
+
+    // Start each session somewhere new so a rebooted board is not mistaken
+    // for a retransmission of the previous session's first frame. The boot
+    // tick is nearly the same every time, so both come from the TRNG.
+    MXC_TRNG_Init();
+    session_nonce = (uint32_t)MXC_TRNG_RandomInt();
+    next_seq = (uint32_t)MXC_TRNG_RandomInt() & CLOUD_SEQ_MASK;
+    MXC_TRNG_Shutdown();
+    base_seq = next_seq;
+
+    // The session's SYN frame announces our frame size limit
+    window_push_hello();
+
+    while (1) {
+        // Fill the window (only one frame until the session start is ACKed)
+        uint8_t limit = syn_pending ? 1 : CLOUD_TX_WINDOW;
+        if (tx_count < limit) {
+            window_push_diag();
+        }
+        if (tx_count < limit && !updates_waiting()) {
+            window_push_report();
+        }
+        while (tx_count < limit) {
+            TickType_t wait = (tx_count == 0) ? pdMS_TO_TICKS(IDLE_POLL_MS) : 0;
+            if (!window_push(wait)) {
+                break;
             }
+            limit = syn_pending ? 1 : CLOUD_TX_WINDOW;
+        }
+
+        if (tx_count == 0) {
+            continue;
+        }
+
+        // Sleep until an ACK arrives or the next frame times out
+        uint32_t signals = task_signal_wait(TASK_SIGNAL_ACK | TASK_SIGNAL_RESYNC,
+                                            window_retransmit());
+        if (signals & TASK_SIGNAL_ACK) {
+            uint16_t word = latest_ack;
+            cloud_ack ack = { word & 0xFF, word >> 8 };
+            apply_ack(&ack);
+        }
+        if (signals & TASK_SIGNAL_RESYNC) {
+            window_resync();
         }
     }
 }
@@ -4,30 +4,45 @@
 #include "../utils/typing.h"
 
 /**
- * @brief UART RX callback - sends command to queue from ISR context
+ * @brief UART RX callback - publishes command to the event bus
  *
- * Called by UART ISR when valid command frame received.
- * Sends command_event to command_queue with ISR-safe queue operations.
- * Implements drop-oldest strategy if queue full.
+ * Called by the UART link task when a valid command frame is received.
+ * Publishes a command alert_event without blocking; a full bus evicts
+ * lower-ranked events first (see event_bus.h).
+ *
+ * SET_PROFILE is not queued: it is forwarded to the motion task.
  *
  * @param cmd command_type enum from UART parser
+ * @param arg command argument (profile index for SET_PROFILE)
+ */
+void on_message_received(command_type cmd, uint8_t arg);
+
+/**
+ * @brief UART RX callback - signals ACK reception
+ *
+ * Called by the UART link task when a window ACK is received from the gateway.
+ * Forwards it to cloud_send_task, which releases the acknowledged frames.
+ *
+ * @param cum Next sequence number the gateway expects (all earlier received)
+ * @param sack Bit i set: frame cum + 1 + i already received
  */
-void on_message_received(command_type cmd);
+void on_ack_received(uint8_t cum, uint8_t sack);
 
 /**
- * @brief UART RX callback - signals ACK reception from ISR context
+ * @brief UART RX callback - the gateway asks for a resync
  *
- * Called by UART ISR when ACK byte (0xAA) received from gateway.
- * Signals cloud_send_task that message was acknowledged.
+ * Called by the UART link task when the gateway receives frames without
+ * holding a session (it restarted mid-session). cloud_send_task resends
+ * its in-flight frames from the oldest, which carries SYN.
  */
-void on_ack_received(void);
+void on_resync_requested(void);
 
 /**
- * @brief Cloud send task - consumes cloud_update_queue and transmits via UART
+ * @brief Cloud send task - consumes the cloud buffer and transmits via UART
  *
- * Monitors cloud_update_queue for events from AlertControlTask, serializes
- * to pipe-delimited format, and transmits via UART with timeout/retry logic.
- * Implements connection status tracking (online/offline).
+ * Monitors the cloud buffer (and flash log) for events from AlertControlTask, encodes them
+ * as 12-byte binary messages, and transmits via UART with a sliding window of
+ * sequenced frames, cumulative/selective ACKs and per-frame retransmission.
  *
  * @param pvParameters FreeRTOS task parameter (unused)
  */
@@ -0,0 +1,72 @@
+#ifndef __CRC16_H
+#define __CRC16_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * CRC-16 used by the UART link (reflected poly 0x8408, init 0xFFFF,
+ * no final XOR - the gateway's crc16.py computes the same value).
+ *
+ * crc16_compute / crc16_update pick the fastest path that is available:
+ * the MAX32655 CRC peripheral if it passed its self-test in crc16_init,
+ * otherwise slicing-by-8 tables. All paths give identical results.
+ */
+
+// CRC-16 initial value - start all CRC calculations with this value
+#define CRC16_INIT      0xffff
+
+// Set to 0 to never touch the CRC peripheral
+#ifndef CRC16_USE_HW
+#define CRC16_USE_HW    1
+#endif
+
+// Lookup tables, one copy in flash for every caller.
+// [0] is the byte-at-a-time table, [1..7] are the slicing tables.
+extern const uint16_t crc16_tables[8][256];
+
+// Probe the CRC peripheral against a known vector (call once at startup)
+void crc16_init(void);
+
+// CRC over buf, starting from CRC16_INIT
+uint16_t crc16_compute(const uint8_t *buf, size_t len);
+
+// Continue a running CRC over more bytes
+uint16_t crc16_update(uint16_t crc, const uint8_t *buf, size_t len);
+
+// Single byte step (table lookup), for byte-by-byte parsers
+static inline uint16_t crc16_update_byte(uint16_t crc, uint8_t byte)
+{
+    return (crc >> 8) ^ crc16_tables[0][(crc ^ byte) & 0xff];
+}
+
+
+/***** Individual implementations (benchmarking) *****/
+typedef enum crc16_impl {
+    CRC16_IMPL_BYTEWISE = 0,   // Original 256-entry table, one byte per step
+    CRC16_IMPL_SLICE4,         // 4 bytes per step, 4 tables
+    CRC16_IMPL_SLICE8,         // 8 bytes per step, 8 tables
+    CRC16_IMPL_HW,             // CRC peripheral
+    CRC16_IMPL_COUNT
+} crc16_impl;
+
+uint16_t crc16_update_impl(crc16_impl impl, uint16_t crc, const uint8_t *buf, size_t len);
+
+// True if the CRC peripheral passed its self-test
+int crc16_hw_available(void);
+
+typedef struct crc16_bench {
+    uint32_t bytes;                       // Bytes hashed per implementation
+    uint32_t cycles[CRC16_IMPL_COUNT];    // DWT cycles over all vectors
+    uint32_t mismatches;                  // Results that differ from BYTEWISE
+} crc16_bench;
+
+/*
+ * Runs every implementation over the same fixed set of frame-sized
+ * vectors and records total cycles. Cycles per byte = cycles / bytes.
+ * Skips CRC16_IMPL_HW (cycles left at 0) if the peripheral is unavailable.
+ * Target only (DWT); tests/crc16_bench.c times the software paths on a host.
+ */
+void crc16_benchmark(crc16_bench *result);
+
+#endif
@@ -1,53 +1,180 @@
 #include "mxc_device.h"
 #include "uart.h"
 #include "nvic_table.h"
+#include "tmr.h"
 #include <stddef.h>
 #include <string.h>
+#include <stdbool.h>
+#include <stdlib.h>
 
 #include "uart_coms.h"
-#include "crc.h"
+#include "crc16.h"
 #include <stdio.h>
 #include "FreeRTOS.h"
 #include "task.h"
+#include "stream_buffer.h"
 #include "cloud_tasks.h"
+#include "../utils/task_signal.h"
 
 #define BAUD_RATE 115200
 #define PROTOCOL_STX 0x02
 #define PROTOCOL_ETX 0x03
 #define ACK_BYTE 0xAA
-#define MAX_DATA_LENGTH 16
+#define ACK_CHECK_XOR 0x55
+#define MAX_DATA_LENGTH UART_MAX_DATA_LENGTH
+
+// Link-level HELLO from the gateway: "HELLO:<largest frame it accepts>[:COBS]"
+#define HELLO_PREFIX "HELLO:"
+#define HELLO_COBS   "COBS"
+// Link-level resync request: the gateway has no window state for our frames
+#define RESYNC_REQUEST "RESYNC"
+
+/*
+ * COBS link mode. Each packet is [kind][body...][crc_low][crc_high]
+ * (CRC over kind and body), COBS-encoded so it holds no zero byte, and
+ * ends with a single 0x00. A receiver that loses sync only has to wait
+ * for the next zero, so line noise costs at most the packet it hit.
+ * A packet sent after the line has been idle also starts with a 0x00, so
+ * noise picked up while idle is not glued onto it; back-to-back packets
+ * share the previous one's delimiter.
+ * Overhead: one code byte per 254 bytes plus one or two delimiters.
+ */
+#define COBS_DELIMITER       0x00
+#define COBS_BLOCK_MAX       254
+#define COBS_KIND_DATA       0x01  // Body = frame payload
+#define COBS_KIND_ACK        0x02  // Body = [cum][sack]
+#define COBS_PACKET_OVERHEAD 3     // Kind + CRC
+#define COBS_RX_BUFFER_SIZE  (MAX_DATA_LENGTH + COBS_PACKET_OVERHEAD)
+#define COBS_RX_EXT_SIZE     (UART_EXT_MAX_DATA_LENGTH + COBS_PACKET_OVERHEAD)
+
+// TX ring buffer, must be a power of two (index wrap uses a mask).
+// Holds one largest frame plus the tail of a previous timed-out one.
+#define UART_TX_RING_SIZE 512
+
+// Commands are short ASCII words; longer payloads are not commands
+#define MAX_COMMAND_LENGTH 16
+
+/*
+ * RX batching. The first byte of a burst interrupts at threshold 1, then
+ * the threshold is raised so the rest of the burst arrives in FIFO-sized
+ * batches. The UART has no receive-timeout interrupt, so TMR2 is run as
+ * a one-shot idle timer: if no batch arrives for RX_IDLE_CHARS character
+ * times it drains the leftovers and drops the threshold back to 1.
+ */
+#define UART_FIFO_DEPTH     8   // MAX32655 UART RX/TX FIFO size
+#define UART_RX_THRESHOLD   4   // Leaves 4 bytes (~350 us) of FIFO headroom
+#define UART_RX_IDLE_CHARS  3
+#define UART_RX_IDLE_TMR    MXC_TMR2
+#define UART_BITS_PER_CHAR  10  // 8N1
+
+// Raw RX bytes between UART0_Handler and the link task
+#define UART_RX_STREAM_SIZE 128
 
 typedef enum {
     STATE_WAIT_STX,      // Waiting for STX (0x02)
-    STATE_READ_LENGTH,   // Reading length byte
+    STATE_READ_LENGTH,   // Reading length byte (0 = extended frame)
+    STATE_READ_EXT_LEN_LOW,  // Extended frame: length low byte
+    STATE_READ_EXT_LEN_HIGH, // Extended frame: length high byte
     STATE_READ_DATA,     // Reading data bytes
     STATE_READ_CRC_LOW,  // Reading CRC low byte
     STATE_READ_CRC_HIGH, // Reading CRC high byte
-    STATE_WAIT_ETX       // Waiting for ETX (0x03)
+    STATE_WAIT_ETX,      // Waiting for ETX (0x03)
+    STATE_ACK_CUM,       // ACK: next sequence number the gateway expects
+    STATE_ACK_SACK,      // ACK: selective bitmap of frames after it
+    STATE_ACK_CHECK      // ACK: cum ^ sack ^ 0x55
 } uart_rx_state_t;
 
 typedef struct {
     uart_rxMessage_cbt uart_rxMessage_cb;
     uart_rx_state_t state;
-    uint8_t data_buffer[MAX_DATA_LENGTH];
-    uint8_t data_length;
-    uint8_t data_index;
+    uint8_t data_buffer[MAX_DATA_LENGTH];  // Short frames
+    uint8_t* data;                         // data_buffer, or rx_ext_alloc() for extended frames
+    uint16_t data_length;
+    uint16_t data_index;
     uint16_t calculated_crc;
     uint16_t received_crc;
+    uint8_t ack_cum;
+    uint8_t ack_sack;
+
+    // COBS decoder (only fed once the link is in COBS mode)
+    uint8_t cobs_buffer[COBS_RX_BUFFER_SIZE];
+    uint8_t* cobs_data;      // cobs_buffer, or rx_ext_alloc() once a packet outgrows it
+    uint16_t cobs_length;    // Decoded bytes so far
+    uint8_t cobs_code;       // Code byte of the current block
+    uint8_t cobs_remaining;  // Encoded bytes left in the current block
+    bool cobs_error;         // Drop everything up to the next delimiter
 } uart_vars_t;
 
 static uart_vars_t uart_vars;
 
+static uart_rxBulk_cbt uart_rxBulk_cb = NULL;
+
+// Largest payload the gateway accepts; short frames only until it says HELLO
+static volatile uint16_t peer_max_length = MAX_DATA_LENGTH;
+
+// Gateway accepted COBS framing in its HELLO
+static volatile bool link_cobs = false;
+
+/*
+ * Transmit path: the sender copies the frame into the ring (in ring-sized
+ * pieces for extended frames) and the TX half-empty interrupt moves it
+ * into the hardware FIFO. When the ring runs dry the interrupt is
+ * disabled and the sender is woken (TASK_SIGNAL_TX_DONE), so frame time
+ * is set by the baud rate, not the RTOS tick.
+ * Single producer (cloud_send_task) / single consumer (UART0 ISR).
+ */
+static uint8_t tx_ring[UART_TX_RING_SIZE];
+static volatile uint32_t tx_head = 0;   // written by the sender
+static volatile uint32_t tx_tail = 0;   // written by the ISR
+static TaskHandle_t tx_task = NULL;     // the sender, woken by the ISR
+
+static uart_rx_stats rx_stats;
+static uart_tx_stats tx_stats;
+
+// COBS encoder block: [code][up to COBS_BLOCK_MAX bytes]. Sender only.
+static uint8_t cobs_block[COBS_BLOCK_MAX + 1];
+static uint8_t cobs_block_length;
+static TickType_t cobs_last_tick;  // When the previous COBS packet was queued
+
+/*
+ * Receive path: the ISRs only copy FIFO bytes into rx_stream. Deframing,
+ * CRC checking and command decoding run in uart_link_task.
+ */
+static StreamBufferHandle_t rx_stream = NULL;
+static StaticStreamBuffer_t rx_stream_struct;
+static uint8_t rx_stream_storage[UART_RX_STREAM_SIZE + 1];  // One byte is never used
+
+/**
+ * @brief Profile names accepted after the "PROF:" prefix
+ *
+ * Index matches the motion_profile enum.
+ */
+static const char* const profile_names[] = {
+    "QUIET",      // MOTION_PROFILE_MUSEUM_QUIET
+    "TRAFFIC",    // MOTION_PROFILE_HIGH_TRAFFIC
+    "TRANSPORT"   // MOTION_PROFILE_TRANSPORT
+};
+
+#define PROFILE_PREFIX "PROF:"
+
 /**
  * @brief Parse command string to command_type enum
  *
  * @param data Pointer to command data buffer
  * @param length Length of command string
+ * @param arg Output for the command argument (profile index for SET_PROFILE)
  * @return command_type enum value or UNKNOWN_COMMAND if not recognized
  */
-static command_type parse_command(const uint8_t* data, uint8_t length)
+static command_type parse_command(const uint8_t* data, uint8_t length, uint8_t* arg)
 {
-    char cmd_str[MAX_DATA_LENGTH + 1];
+    char cmd_str[MAX_COMMAND_LENGTH + 1];
+
+    *arg = 0;
+
+    if (length > MAX_COMMAND_LENGTH) {
+        return UNKNOWN_COMMAND;
+    }
+
     memcpy(cmd_str, data, length);
     cmd_str[length] = '\0';
 
@@ -57,126 +184,555 @@ static command_type parse_command(const uint8_t* data, uint8_t length)
         return DISARM;
     } else if (strcmp(cmd_str, "RESOLVE") == 0) {
         return RESOLVE_ALARM;
+    } else if (strncmp(cmd_str, PROFILE_PREFIX, strlen(PROFILE_PREFIX)) == 0) {
+        const char* name = cmd_str + strlen(PROFILE_PREFIX);
+        for (uint8_t i = 0; i < sizeof(profile_names) / sizeof(profile_names[0]); i++) {
+            if (strcmp(name, profile_names[i]) == 0) {
+                *arg = i;
+                return SET_PROFILE;
+            }
+        }
     }
 
     return UNKNOWN_COMMAND;
 }
 
 /**
- * @brief UART0 interrupt handler with state machine for STX/ETX frame parsing
+ * @brief Move queued TX bytes into the hardware FIFO
+ *
+ * Called from the UART0 ISR (and once by the sender to prime the FIFO
+ * with the interrupt masked). Returns true when the ring is empty.
+ */
+static bool tx_fill_fifo(void)
+{
+    while (tx_tail != tx_head) {
+        uint32_t idx = tx_tail & (UART_TX_RING_SIZE - 1);
+
+        // Largest contiguous run before the ring wraps
+        uint32_t run = tx_head - tx_tail;
+        if (run > UART_TX_RING_SIZE - idx) {
+            run = UART_TX_RING_SIZE - idx;
+        }
+
+        int written = MXC_UART_WriteTXFIFO(MXC_UART0, &tx_ring[idx], run);
+        if (written <= 0) {
+            return false;  // FIFO full - wait for the next TX_HE
+        }
+        tx_tail += written;
+    }
+
+    return true;
+}
+
+/**
+ * @brief UART0 TX half-empty handling (ISR context)
+ */
+static void uart_tx_isr(void)
+{
+    if (tx_fill_fifo()) {
+        // Ring drained - stop TX interrupts and release the sender
+        MXC_UART_DisableInt(MXC_UART0, MXC_F_UART_INT_EN_TX_HE);
+
+        BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+        task_signal_raise_from_isr(tx_task, TASK_SIGNAL_TX_DONE, &xHigherPriorityTaskWoken);
+        portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+    }
+}
+
+/**
+ * @brief Buffers for extended frames and large COBS packets (link task only)
+ *
+ * Taken from the heap, sized to the frame. Without a heap (STATIC_ALLOC=1)
+ * one static buffer of the largest size is lent to whichever decoder needs
+ * it first; the other counts an ext_alloc_failure, as with an exhausted heap.
+ */
+#if configSUPPORT_DYNAMIC_ALLOCATION
+static uint8_t* rx_ext_alloc(size_t size)
+{
+    return pvPortMalloc(size);
+}
+
+static void rx_ext_free(uint8_t* buffer)
+{
+    vPortFree(buffer);
+}
+#else
+static uint8_t rx_ext_buffer[COBS_RX_EXT_SIZE];
+static bool rx_ext_lent = false;
+
+static uint8_t* rx_ext_alloc(size_t size)
+{
+    if (rx_ext_lent || size > sizeof(rx_ext_buffer)) {
+        return NULL;
+    }
+    rx_ext_lent = true;
+    return rx_ext_buffer;
+}
+
+static void rx_ext_free(uint8_t* buffer)
+{
+    (void)buffer;
+    rx_ext_lent = false;
+}
+#endif
+
+/**
+ * @brief Run one received byte through the STX/ETX frame state machine
+ *
+ * Link task context. The registered callbacks run from here too.
  *
- * Handles incoming UART data byte-by-byte using state machine to parse binary frames.
  * Frame format: [STX][length][data...][crc_low][crc_high][ETX]
+ * Extended:     [STX][0][len_low][len_high][data...][crc_low][crc_high][ETX]
+ * ACK format:   [0xAA][cum][sack][cum ^ sack ^ 0x55]   (STX/ETX mode only)
  *
  * State transitions:
- * - WAIT_STX: Wait for STX (0x02), initialize CRC
- * - READ_LENGTH: Read and validate length byte (1-16)
- * - READ_DATA: Accumulate data bytes, update CRC
+ * - WAIT_STX: Wait for STX (0x02); 0xAA starts an ACK
+ * - READ_LENGTH: Read and validate length byte (1-MAX_DATA_LENGTH, 0 = extended)
+ * - READ_EXT_LEN_LOW / HIGH: 16-bit length, payload buffer taken from the heap
+ * - READ_DATA: Accumulate data bytes, CRC them once complete
  * - READ_CRC_LOW: Read CRC low byte
  * - READ_CRC_HIGH: Read CRC high byte
  * - WAIT_ETX: Validate ETX and CRC, invoke callback if valid
+ * - ACK_CUM / ACK_SACK / ACK_CHECK: collect and validate a window ACK
  *
  * Invalid frames are silently discarded.
  */
-void UART0_Handler(void)
+static void rx_abort(void)
 {
-    if (MXC_UART_GetFlags(MXC_UART0) & MXC_F_UART_INT_FL_RX_THD) {
-        uint8_t byte;
-        MXC_UART_ReadRXFIFO(MXC_UART0, &byte, 1);
-        MXC_UART_ClearFlags(MXC_UART0, MXC_F_UART_INT_FL_RX_THD);
+    // Extended frame buffers only live for the duration of one frame
+    if (uart_vars.data != uart_vars.data_buffer) {
+        rx_ext_free(uart_vars.data);
+        uart_vars.data = uart_vars.data_buffer;
+    }
+    uart_vars.state = STATE_WAIT_STX;
+}
 
-        switch (uart_vars.state) {
-            case STATE_WAIT_STX:
-                // Idle state - waiting for frame start marker or standalone ACK
-                if (byte == PROTOCOL_STX) {
-                    // Start of frame detected - prepare to receive new message
-                    uart_vars.state = STATE_READ_LENGTH;
+/**
+ * @brief Deliver a CRC-checked frame payload
+ */
+static void rx_dispatch(const uint8_t* data, uint16_t length)
+{
+    // Link-level HELLO is consumed here, never seen by the application
+    if (length > strlen(HELLO_PREFIX) && length <= MAX_COMMAND_LENGTH &&
+        memcmp(data, HELLO_PREFIX, strlen(HELLO_PREFIX)) == 0) {
+        char num[MAX_COMMAND_LENGTH + 1];
+        memcpy(num, data + strlen(HELLO_PREFIX), length - strlen(HELLO_PREFIX));
+        num[length - strlen(HELLO_PREFIX)] = '\0';
 
-                    // Initialize CRC calculation (all frames include length and data in CRC)
-                    uart_vars.calculated_crc = CRCINIT;
+        char* end;
+        uint32_t peer = strtoul(num, &end, 10);
+        peer_max_length = (peer < UART_EXT_MAX_DATA_LENGTH) ? peer : UART_EXT_MAX_DATA_LENGTH;
+        if (peer_max_length < MAX_DATA_LENGTH) {
+            peer_max_length = MAX_DATA_LENGTH;
+        }
 
-                    // Clear data buffer to ensure clean state for new frame
-                    memset(uart_vars.data_buffer, 0, MAX_DATA_LENGTH);
+        // Switch framing right away: the gateway sends COBS after this reply
+        link_cobs = (*end == ':' && strcmp(end + 1, HELLO_COBS) == 0);
+        return;
+    }
 
-                } else if (byte == ACK_BYTE) {
-                    // Standalone ACK byte (0xAA) received from gateway
-                    // This acknowledges a frame we previously sent
-                    // Signal the cloud_send_task via semaphore to unblock waiting
-                    on_ack_received();
-                }
-                // Any other byte: noise or out-of-sync data - ignore and stay in WAIT_STX
-                break;
+    if (length == strlen(RESYNC_REQUEST) && memcmp(data, RESYNC_REQUEST, length) == 0) {
+        on_resync_requested();
+        return;
+    }
 
-            case STATE_READ_LENGTH:
-                // Read the length byte which tells us how many data bytes to expect
-                uart_vars.data_length = byte;
-                uart_vars.data_index = 0;  // Reset buffer index for incoming data
-
-                // Length byte is included in CRC calculation
-                uart_vars.calculated_crc = crc_iterate(uart_vars.calculated_crc, byte);
-
-                // Validate length is within acceptable range (1-16 bytes)
-                if (uart_vars.data_length > 0 && uart_vars.data_length <= MAX_DATA_LENGTH) {
-                    // Valid length - proceed to read data bytes
-                    uart_vars.state = STATE_READ_DATA;
-                } else {
-                    // Invalid length (0 or >16) - malformed frame
-                    // Abort and return to idle state to resynchronize
-                    uart_vars.state = STATE_WAIT_STX;
-                }
-                break;
+    if (length <= MAX_COMMAND_LENGTH) {
+        uint8_t arg;
+        command_type cmd = parse_command(data, (uint8_t)length, &arg);
 
-            case STATE_READ_DATA:
-                // Accumulate data bytes into buffer while updating CRC
-                // Store the byte in the buffer at the current index (then increment index)
-                uart_vars.data_buffer[uart_vars.data_index++] = byte;
+        // Invoke callback if command is recognized and callback is registered
+        if (cmd != UNKNOWN_COMMAND && uart_vars.uart_rxMessage_cb != NULL) {
+            uart_vars.uart_rxMessage_cb(cmd, arg);
+        }
+        return;
+    }
 
-                // Update running CRC calculation with this data byte
-                uart_vars.calculated_crc = crc_iterate(uart_vars.calculated_crc, byte);
+    // Anything larger is a blob (configuration, diagnostics request, ...)
+    if (uart_rxBulk_cb != NULL) {
+        uart_rxBulk_cb(data, length);
+    }
+}
 
-                // Check if we've received all expected data bytes
-                if (uart_vars.data_index >= uart_vars.data_length) {
-                    // All data received - next bytes will be CRC (low byte first)
-                    uart_vars.state = STATE_READ_CRC_LOW;
-                }
-                break;
+static void legacy_rx_byte(uint8_t byte)
+{
+    switch (uart_vars.state) {
+        case STATE_WAIT_STX:
+            // Idle state - waiting for frame start marker or standalone ACK
+            if (byte == PROTOCOL_STX) {
+                // Start of frame detected - prepare to receive new message
+                uart_vars.state = STATE_READ_LENGTH;
+
+
+                // Clear data buffer to ensure clean state for new frame
+                memset(uart_vars.data_buffer, 0, MAX_DATA_LENGTH);
+
+            } else if (byte == ACK_BYTE && !link_cobs) {
+                // Window ACK from the gateway - three more bytes follow
+                // (COBS mode ACKs are packets; a bare 0xAA is just data)
+                uart_vars.state = STATE_ACK_CUM;
+            }
+            // Any other byte: noise or out-of-sync data - ignore and stay in WAIT_STX
+            break;
+
+        case STATE_READ_LENGTH:
+            // Read the length byte which tells us how many data bytes to expect
+            uart_vars.data_length = byte;
+            uart_vars.data_index = 0;  // Reset buffer index for incoming data
+
+            // CRC covers the length byte and the data (data is hashed in bulk below)
+            uart_vars.calculated_crc = crc16_update_byte(CRC16_INIT, byte);
+
+            // Validate length is within acceptable range (1-MAX_DATA_LENGTH bytes)
+            if (uart_vars.data_length > 0 && uart_vars.data_length <= MAX_DATA_LENGTH) {
+                // Valid length - proceed to read data bytes
+                uart_vars.data = uart_vars.data_buffer;
+                uart_vars.state = STATE_READ_DATA;
+            } else if (!link_cobs) {
+                // Length 0 introduces an extended frame with a 16-bit length
+                uart_vars.state = STATE_READ_EXT_LEN_LOW;
+            } else {
+                // COBS mode: only short legacy commands from a restarted gateway
+                rx_abort();
+            }
+            break;
+
+        case STATE_READ_EXT_LEN_LOW:
+            uart_vars.data_length = byte;
+            uart_vars.calculated_crc = crc16_update_byte(uart_vars.calculated_crc, byte);
+            uart_vars.state = STATE_READ_EXT_LEN_HIGH;
+            break;
 
-            case STATE_READ_CRC_LOW:
-                // Read the low byte (LSB) of the 16-bit CRC sent by transmitter
-                // CRC is transmitted little-endian: low byte first, high byte second
-                uart_vars.received_crc = byte;  // Store low 8 bits
-                uart_vars.state = STATE_READ_CRC_HIGH;
+        case STATE_READ_EXT_LEN_HIGH:
+            uart_vars.data_length |= (uint16_t)byte << 8;
+            uart_vars.calculated_crc = crc16_update_byte(uart_vars.calculated_crc, byte);
+
+            // Extended frames are for payloads that don't fit a short frame
+            if (uart_vars.data_length <= MAX_DATA_LENGTH ||
+                uart_vars.data_length > UART_EXT_MAX_DATA_LENGTH) {
+                rx_abort();
                 break;
+            }
 
-            case STATE_READ_CRC_HIGH:
-                // Read the high byte (MSB) of the 16-bit CRC
-                // Combine with low byte to form complete 16-bit CRC value
-                uart_vars.received_crc |= (byte << 8);  // Shift high byte left, OR with low byte
-                uart_vars.state = STATE_WAIT_ETX;
+            // Buffer sized to this frame, not the worst case
+            uart_vars.data = rx_ext_alloc(uart_vars.data_length);
+            if (uart_vars.data == NULL) {
+                rx_stats.ext_alloc_failures++;
+                uart_vars.data = uart_vars.data_buffer;
+                rx_abort();
                 break;
+            }
+            uart_vars.state = STATE_READ_DATA;
+            break;
+
+        case STATE_READ_DATA:
+            // Accumulate data bytes into buffer
+            // Store the byte in the buffer at the current index (then increment index)
+            uart_vars.data[uart_vars.data_index++] = byte;
+
+            // Check if we've received all expected data bytes
+            if (uart_vars.data_index >= uart_vars.data_length) {
+                // All data received - hash it in one pass (tables or CRC peripheral)
+                uart_vars.calculated_crc = crc16_update(uart_vars.calculated_crc,
+                                                        uart_vars.data,
+                                                        uart_vars.data_length);
+
+                // Next bytes will be CRC (low byte first)
+                uart_vars.state = STATE_READ_CRC_LOW;
+            }
+            break;
+
+        case STATE_READ_CRC_LOW:
+            // Read the low byte (LSB) of the 16-bit CRC sent by transmitter
+            // CRC is transmitted little-endian: low byte first, high byte second
+            uart_vars.received_crc = byte;  // Store low 8 bits
+            uart_vars.state = STATE_READ_CRC_HIGH;
+            break;
 
-            case STATE_WAIT_ETX:
-                // Expecting ETX frame terminator - validate and process if present
-                if (byte == PROTOCOL_ETX) {
-                    // Valid frame terminator received - now validate CRC checksum
-                    if (uart_vars.calculated_crc == uart_vars.received_crc) {
-                        // CRC matches - frame is valid, parse the command
-                        command_type cmd = parse_command(uart_vars.data_buffer, uart_vars.data_length);
-
-                        // Invoke callback if command is recognized and callback is registered
-                        if (cmd != UNKNOWN_COMMAND && uart_vars.uart_rxMessage_cb != NULL) {
-                            uart_vars.uart_rxMessage_cb(cmd);
-                        }
-                    }
-                    // If CRC mismatch: silently discard frame (as per spec)
-                    // This prevents acting on corrupted data
+        case STATE_READ_CRC_HIGH:
+            // Read the high byte (MSB) of the 16-bit CRC
+            // Combine with low byte to form complete 16-bit CRC value
+            uart_vars.received_crc |= (byte << 8);  // Shift high byte left, OR with low byte
+            uart_vars.state = STATE_WAIT_ETX;
+            break;
+
+        case STATE_WAIT_ETX:
+            // Expecting ETX frame terminator - validate and process if present
+            if (byte == PROTOCOL_ETX) {
+                // Valid frame terminator received - now validate CRC checksum
+                if (uart_vars.calculated_crc == uart_vars.received_crc) {
+                    // CRC matches - frame is valid, hand it on
+                    rx_dispatch(uart_vars.data, uart_vars.data_length);
                 }
-                // If byte != ETX: frame is malformed, discard
+                // If CRC mismatch: silently discard frame (as per spec)
+                // This prevents acting on corrupted data
+            }
+            // If byte != ETX: frame is malformed, discard
 
-                // Always reset state machine to wait for next frame
-                // Even on error, we return to idle state to resynchronize
-                uart_vars.state = STATE_WAIT_STX;
-                break;
+            // Always reset state machine to wait for next frame
+            // Even on error, we return to idle state to resynchronize
+            rx_abort();
+            break;
+
+        case STATE_ACK_CUM:
+            uart_vars.ack_cum = byte;
+            uart_vars.state = STATE_ACK_SACK;
+            break;
+
+        case STATE_ACK_SACK:
+            uart_vars.ack_sack = byte;
+            uart_vars.state = STATE_ACK_CHECK;
+            break;
+
+        case STATE_ACK_CHECK:
+            // Check byte guards against a stray 0xAA starting a bogus ACK
+            if (byte == (uart_vars.ack_cum ^ uart_vars.ack_sack ^ ACK_CHECK_XOR)) {
+                on_ack_received(uart_vars.ack_cum, uart_vars.ack_sack);
+            }
+            uart_vars.state = STATE_WAIT_STX;
+            break;
+    }
+}
+
+/**
+ * @brief Drop the COBS packet being decoded
+ */
+static void cobs_rx_reset(void)
+{
+    if (uart_vars.cobs_data != uart_vars.cobs_buffer) {
+        rx_ext_free(uart_vars.cobs_data);
+        uart_vars.cobs_data = uart_vars.cobs_buffer;
+    }
+    uart_vars.cobs_length = 0;
+    uart_vars.cobs_code = 0xFF;  // No implicit zero before the first block
+    uart_vars.cobs_remaining = 0;
+    uart_vars.cobs_error = false;
+}
+
+/**
+ * @brief Append one decoded byte, moving to a heap buffer for large packets
+ */
+static bool cobs_rx_put(uint8_t byte)
+{
+    if (uart_vars.cobs_length == COBS_RX_BUFFER_SIZE && uart_vars.cobs_data == uart_vars.cobs_buffer) {
+        uint8_t* ext = rx_ext_alloc(COBS_RX_EXT_SIZE);
+        if (ext == NULL) {
+            rx_stats.ext_alloc_failures++;
+            return false;
+        }
+        memcpy(ext, uart_vars.cobs_buffer, COBS_RX_BUFFER_SIZE);
+        uart_vars.cobs_data = ext;
+    }
+
+    if (uart_vars.cobs_length == COBS_RX_EXT_SIZE) {
+        return false;  // Longer than any valid packet
+    }
+
+    uart_vars.cobs_data[uart_vars.cobs_length++] = byte;
+    return true;
+}
+
+/**
+ * @brief Check and deliver a decoded COBS packet
+ */
+static void cobs_rx_packet(const uint8_t* packet, uint16_t length)
+{
+    if (length < COBS_PACKET_OVERHEAD) {
+        rx_stats.cobs_errors++;
+        return;
+    }
+
+    uint16_t body_length = length - COBS_PACKET_OVERHEAD;
+    uint16_t received_crc = packet[length - 2] | (packet[length - 1] << 8);
+
+    if (crc16_update(CRC16_INIT, packet, length - 2) != received_crc) {
+        rx_stats.cobs_errors++;
+        return;
+    }
+
+    const uint8_t* body = &packet[1];
+
+    if (packet[0] == COBS_KIND_ACK && body_length == 2) {
+        on_ack_received(body[0], body[1]);
+    } else if (packet[0] == COBS_KIND_DATA && body_length > 0) {
+        rx_dispatch(body, body_length);
+    } else {
+        rx_stats.cobs_errors++;
+    }
+}
+
+/**
+ * @brief Run one received byte through the COBS decoder
+ *
+ * Blocks are [code][code - 1 bytes]; every block except a full one
+ * (code 0xFF) and the last is followed by an implicit zero. A zero on
+ * the line always ends the packet, whatever state the decoder is in.
+ */
+static void cobs_rx_byte(uint8_t byte)
+{
+    if (byte == COBS_DELIMITER) {
+        if (uart_vars.cobs_length > 0 || uart_vars.cobs_remaining > 0) {
+            if (!uart_vars.cobs_error && uart_vars.cobs_remaining == 0) {
+                cobs_rx_packet(uart_vars.cobs_data, uart_vars.cobs_length);
+            } else {
+                rx_stats.cobs_errors++;
+            }
+        }
+        cobs_rx_reset();
+        return;
+    }
+
+    if (uart_vars.cobs_error) {
+        return;
+    }
+
+    bool ok = true;
+    if (uart_vars.cobs_remaining == 0) {
+        // Code byte: the previous block ended with a zero unless it was full
+        if (uart_vars.cobs_code != 0xFF) {
+            ok = cobs_rx_put(0);
+        }
+        uart_vars.cobs_code = byte;
+        uart_vars.cobs_remaining = byte - 1;
+    } else {
+        ok = cobs_rx_put(byte);
+        uart_vars.cobs_remaining--;
+    }
+
+    if (!ok) {
+        uart_vars.cobs_error = true;
+    }
+}
+
+/**
+ * @brief Feed one received byte to the link parsers
+ *
+ * STX/ETX frames are always accepted (a restarted gateway talks legacy
+ * until the next HELLO); COBS packets only once COBS was negotiated.
+ */
+static void uart_rx_byte(uint8_t byte)
+{
+    if (link_cobs) {
+        cobs_rx_byte(byte);
+    }
+    legacy_rx_byte(byte);
+}
+
+/**
+ * @brief Move everything currently in the RX FIFO into rx_stream (ISR context)
+ *
+ * @return Number of bytes drained
+ */
+static uint32_t uart_rx_drain(BaseType_t *xHigherPriorityTaskWoken)
+{
+    uint8_t batch[UART_FIFO_DEPTH];
+    uint32_t total = 0;
+    int n;
+
+    // Bytes can keep arriving while we copy - loop until the FIFO is empty
+    while ((n = MXC_UART_ReadRXFIFO(MXC_UART0, batch, sizeof(batch))) > 0) {
+        size_t sent = xStreamBufferSendFromISR(rx_stream, batch, n,
+                                               xHigherPriorityTaskWoken);
+        // Link task fell behind - the parser resyncs on the next STX
+        rx_stats.dropped += n - sent;
+        total += n;
+    }
+
+    rx_stats.rx_bytes += total;
+    if (total > rx_stats.max_batch) {
+        rx_stats.max_batch = total;
+    }
+
+    return total;
+}
+
+/**
+ * @brief (Re)start the RX idle timer
+ */
+static void rx_idle_restart(void)
+{
+    MXC_TMR_Stop(UART_RX_IDLE_TMR);
+    MXC_TMR_SetCount(UART_RX_IDLE_TMR, 0);
+    MXC_TMR_Start(UART_RX_IDLE_TMR);
+}
+
+/**
+ * @brief TMR2 handler - emulated receive timeout
+ *
+ * The line has been quiet for UART_RX_IDLE_CHARS character times: pick up
+ * the tail of the burst that never reached the threshold and go back to
+ * interrupting on the first byte.
+ */
+void TMR2_Handler(void)
+{
+    MXC_TMR_ClearFlags(UART_RX_IDLE_TMR);
+    MXC_TMR_Stop(UART_RX_IDLE_TMR);
+
+    rx_stats.timeout_entries++;
+
+    // Same priority as UART0, so the two handlers never interleave
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    uart_rx_drain(&xHigherPriorityTaskWoken);
+    MXC_UART_SetRXThreshold(MXC_UART0, 1);
+
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+/**
+ * @brief UART0 interrupt handler
+ *
+ * RX: drains the whole FIFO per entry into the link task's stream
+ * buffer. After the first byte of a burst the RX threshold is raised to
+ * UART_RX_THRESHOLD and the idle timer (TMR2) picks up the remainder.
+ * TX: services the TX half-empty interrupt for the transmit ring.
+ */
+void UART0_Handler(void)
+{
+    uint32_t flags = MXC_UART_GetFlags(MXC_UART0);
+
+    rx_stats.isr_entries++;
+
+    if (flags & MXC_F_UART_INT_FL_TX_HE) {
+        MXC_UART_ClearFlags(MXC_UART0, MXC_F_UART_INT_FL_TX_HE);
+        uart_tx_isr();
+    }
+
+    if (flags & MXC_F_UART_INT_FL_RX_OV) {
+        MXC_UART_ClearFlags(MXC_UART0, MXC_F_UART_INT_FL_RX_OV);
+        rx_stats.overruns++;
+    }
+
+    if (flags & MXC_F_UART_INT_FL_RX_THD) {
+        BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+        rx_stats.rx_entries++;
+        uart_rx_drain(&xHigherPriorityTaskWoken);
+        MXC_UART_ClearFlags(MXC_UART0, MXC_F_UART_INT_FL_RX_THD);
+
+        // Burst in progress - batch the rest and arm the idle timeout
+        MXC_UART_SetRXThreshold(MXC_UART0, UART_RX_THRESHOLD);
+        rx_idle_restart();
+
+        portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+    }
+}
+
+/**
+ * @brief UART link task - deframes and decodes received bytes
+ *
+ * Blocks on rx_stream and feeds every byte through the frame state machine.
+ * Commands and ACKs are delivered to the callbacks from this task, so
+ * the ISR cost stays the same however the parser grows.
+ */
+void uart_link_task(void *pvParameters)
+{
+    uint8_t chunk[32];
+
+    while (1) {
+        // Trigger level 1: wake as soon as anything is available
+        size_t n = xStreamBufferReceive(rx_stream, chunk, sizeof(chunk), portMAX_DELAY);
+
+        for (size_t i = 0; i < n; i++) {
+            uart_rx_byte(chunk[i]);
         }
     }
 }
@@ -185,15 +741,16 @@ void UART0_Handler(void)
  * @brief Initialize UART0 for receiving binary framed messages
  *
  * Configures UART0 at 115200 baud with RX interrupt enabled. Registers a callback
- * function to be invoked when valid command frames are received.
+ * function to be invoked (from uart_link_task) when valid command frames are received.
  *
  * @param uart_rxMessage_cb Callback function to handle received commands
  *
  * Setup steps:
- * 1. Register callback and initialize state machine
+ * 1. Register callback, initialize state machine and RX stream buffer
  * 2. Configure NVIC for UART0 interrupts
  * 3. Initialize UART0 hardware at BAUD_RATE (115200)
- * 4. Enable RX threshold interrupt
+ * 4. Configure TMR2 as the RX idle timer
+ * 5. Enable RX threshold and overrun interrupts
  *
  * @note Halts execution on UART initialization error
  */
@@ -201,6 +758,21 @@ void uart_init(uart_rxMessage_cbt uart_rxMessage_cb)
 {
     uart_vars.uart_rxMessage_cb = uart_rxMessage_cb;
     uart_vars.state = STATE_WAIT_STX;
+    uart_vars.data = uart_vars.data_buffer;
+    uart_vars.cobs_data = uart_vars.cobs_buffer;
+    cobs_rx_reset();
+
+    // Pick the CRC path (peripheral if it passes its self-test)
+    crc16_init();
+
+    // Raw RX bytes for uart_link_task
+    if (rx_stream == NULL) {
+        rx_stream = xStreamBufferCreateStatic(UART_RX_STREAM_SIZE, 1,
+                                              rx_stream_storage, &rx_stream_struct);
+        if (rx_stream == NULL) {
+            while(1);  // Halt on error
+        }
+    }
 
     NVIC_DisableIRQ(UART0_IRQn); 
     NVIC_ClearPendingIRQ(UART0_IRQn);
@@ -216,75 +788,284 @@ void uart_init(uart_rxMessage_cbt uart_rxMessage_cb)
     MXC_UART_ClearRXFIFO(MXC_UART0);
     MXC_UART_ClearTXFIFO(MXC_UART0);
     
-    // Set RX threshold to 1 byte to trigger interrupt on each received byte
+    // Idle threshold: interrupt on the first byte of a burst
     MXC_UART_SetRXThreshold(MXC_UART0, 1);
 
-    MXC_UART_EnableInt(MXC_UART0, MXC_F_UART_INT_EN_RX_THD);
+    // RX idle timer: one-shot, UART_RX_IDLE_CHARS character times
+    uint32_t idle_us = (UART_RX_IDLE_CHARS * UART_BITS_PER_CHAR * 1000000u) / BAUD_RATE;
+    mxc_tmr_cfg_t tmr_cfg = {
+        .pres    = TMR_PRES_1,
+        .mode    = TMR_MODE_ONESHOT,
+        .bitMode = TMR_BIT_MODE_32,
+        .clock   = MXC_TMR_APB_CLK,
+        .cmp_cnt = (PeripheralClock / 1000000u) * idle_us,
+        .pol     = 0
+    };
+
+    MXC_TMR_Shutdown(UART_RX_IDLE_TMR);
+    MXC_TMR_Init(UART_RX_IDLE_TMR, &tmr_cfg, false);
+    MXC_TMR_Stop(UART_RX_IDLE_TMR);
+    MXC_TMR_ClearFlags(UART_RX_IDLE_TMR);
+    MXC_TMR_EnableInt(UART_RX_IDLE_TMR);
+
+    NVIC_ClearPendingIRQ(TMR2_IRQn);
+    MXC_NVIC_SetVector(TMR2_IRQn, TMR2_Handler);
+    NVIC_EnableIRQ(TMR2_IRQn);
+
+    MXC_UART_EnableInt(MXC_UART0, MXC_F_UART_INT_EN_RX_THD | MXC_F_UART_INT_EN_RX_OV);
 }
 
 /**
- * @brief Transmit single byte over UART0 with timeout detection
+ * @brief Snapshot of the RX interrupt counters
+ */
+void uart_get_rx_stats(uart_rx_stats *stats)
+{
+    taskENTER_CRITICAL();
+    *stats = rx_stats;
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Snapshot of the TX framing counters
+ */
+void uart_get_tx_stats(uart_tx_stats *stats)
+{
+    taskENTER_CRITICAL();
+    *stats = tx_stats;
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Copy bytes into the TX ring (sender context)
+ *
+ * Waits for the ISR to drain the ring whenever it fills, so frames larger
+ * than the ring go out in ring-sized pieces.
  *
- * @param byte Byte to transmit
- * @param timeout_ms Timeout in milliseconds
- * @return 0 on success, -1 on timeout 
- */
-static int uart_txByte_with_timeout(uint8_t byte, uint32_t timeout_ms) {
-    TickType_t start_tick = xTaskGetTickCount();
-    TickType_t timeout_ticks = pdMS_TO_TICKS(timeout_ms);
-
-    while (MXC_UART_GetTXFIFOAvailable(MXC_UART0) == 0) {
-        // Check if timeout exceeded
-        if ((xTaskGetTickCount() - start_tick) >= timeout_ticks) {
-            return -1;  // Timeout 
+ * @return 0 on success, -1 if the deadline passed
+ */
+static int tx_ring_write(const uint8_t* data, uint32_t length, TickType_t deadline)
+{
+    while (length > 0) {
+        uint32_t space = UART_TX_RING_SIZE - (tx_head - tx_tail);
+
+        if (space == 0) {
+            // Ring full - sleep until the ISR has emptied it
+            TickType_t now = xTaskGetTickCount();
+            if ((int32_t)(deadline - now) <= 0 ||
+                task_signal_wait(TASK_SIGNAL_TX_DONE, deadline - now) == 0) {
+                return -1;
+            }
+            continue;
+        }
+
+        uint32_t n = (length < space) ? length : space;
+        for (uint32_t i = 0; i < n; i++) {
+            tx_ring[(tx_head + i) & (UART_TX_RING_SIZE - 1)] = data[i];
         }
+        // Publish the bytes to the ISR in one step
+        tx_head += n;
+        data += n;
+        length -= n;
 
-        // Yield CPU to prevent busy-wait
-        vTaskDelay(1);
+        // Prime the FIFO with the interrupt masked, then let TX_HE take over
+        MXC_UART_DisableInt(MXC_UART0, MXC_F_UART_INT_EN_TX_HE);
+        tx_fill_fifo();
+        MXC_UART_EnableInt(MXC_UART0, MXC_F_UART_INT_EN_TX_HE);
     }
 
-    // FIFO space available - transmit byte
-    MXC_UART_WriteTXFIFO(MXC_UART0, &byte, 1);
     return 0;
 }
 
+/**
+ * @brief Emit the pending COBS block (sender context)
+ */
+static int cobs_tx_flush(TickType_t deadline)
+{
+    uint32_t n = cobs_block_length + 1;
+
+    cobs_block[0] = (uint8_t)n;
+    cobs_block_length = 0;
+    tx_stats.wire_bytes += n;
+    return tx_ring_write(cobs_block, n, deadline);
+}
+
+/**
+ * @brief COBS-encode bytes into the TX ring (sender context)
+ *
+ * Zeros end the current block; a block that reaches COBS_BLOCK_MAX bytes
+ * is sent with code 0xFF (no implied zero). Call cobs_tx_flush and send
+ * the delimiter once the whole packet has been passed in.
+ */
+static int cobs_tx_write(const uint8_t* data, uint32_t length, TickType_t deadline)
+{
+    for (uint32_t i = 0; i < length; i++) {
+        if (data[i] == 0) {
+            if (cobs_tx_flush(deadline) != 0) {
+                return -1;
+            }
+            continue;
+        }
+
+        cobs_block[1 + cobs_block_length++] = data[i];
+        if (cobs_block_length == COBS_BLOCK_MAX && cobs_tx_flush(deadline) != 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Queue one payload as a COBS data packet
+ */
+static int cobs_tx_frame(const uint8_t* data, uint16_t length, TickType_t deadline)
+{
+    static const uint8_t delimiter = COBS_DELIMITER;
+    uint8_t kind = COBS_KIND_DATA;
+
+    uint16_t crc = crc16_update(CRC16_INIT, &kind, 1);
+    crc = crc16_update(crc, data, length);
+    uint8_t trailer[2] = { crc & 0xFF, (crc >> 8) & 0xFF };
+
+    cobs_block_length = 0;
+
+    // Line idle since the last packet: open with a delimiter as well
+    TickType_t now = xTaskGetTickCount();
+    if (tx_stats.cobs_frames == 0 || now != cobs_last_tick) {
+        if (tx_ring_write(&delimiter, 1, deadline) != 0) {
+            return -1;
+        }
+        tx_stats.wire_bytes++;
+    }
+
+    if (cobs_tx_write(&kind, 1, deadline) != 0 ||
+        cobs_tx_write(data, length, deadline) != 0 ||
+        cobs_tx_write(trailer, sizeof(trailer), deadline) != 0 ||
+        cobs_tx_flush(deadline) != 0 ||
+        tx_ring_write(&delimiter, 1, deadline) != 0) {
+        return -1;
+    }
+
+    tx_stats.wire_bytes++;
+    tx_stats.cobs_frames++;
+    cobs_last_tick = xTaskGetTickCount();
+    return 0;
+}
+
+/**
+ * @brief Queue one payload as an STX/ETX frame
+ */
+static int legacy_tx_frame(const uint8_t* data, uint16_t length, TickType_t deadline)
+{
+    uint8_t header[4] = { PROTOCOL_STX };
+    uint32_t header_len;
+
+    if (length <= MAX_DATA_LENGTH) {
+        header[1] = (uint8_t)length;
+        header_len = 2;
+    } else {
+        header[1] = 0;
+        header[2] = length & 0xFF;
+        header[3] = (length >> 8) & 0xFF;
+        header_len = 4;
+    }
+
+    // Calculate CRC over the length field(s) and the data
+    uint16_t crc = crc16_update(CRC16_INIT, &header[1], header_len - 1);
+    crc = crc16_update(crc, data, length);
+
+    uint8_t trailer[3] = { crc & 0xFF, (crc >> 8) & 0xFF, PROTOCOL_ETX };
+
+    if (tx_ring_write(header, header_len, deadline) != 0 ||
+        tx_ring_write(data, length, deadline) != 0 ||
+        tx_ring_write(trailer, sizeof(trailer), deadline) != 0) {
+        return -1;
+    }
+
+    tx_stats.wire_bytes += header_len + length + sizeof(trailer);
+    return 0;
+}
 
 /**
  * @brief Build and transmit framed message with timeout detection
  *
  * Frame format: [STX][length][data...][crc_low][crc_high][ETX]
+ * Payloads over MAX_DATA_LENGTH use the extended format
+ *   [STX][0][len_low][len_high][data...][crc_low][crc_high][ETX]
+ * which is only allowed once the gateway has announced (HELLO) that it
+ * accepts frames that large - see uart_link_max_length().
+ * Once the gateway has accepted COBS the payload goes out as a COBS data
+ * packet instead (see COBS_KIND_DATA), whatever its length.
+ *
+ * The frame is queued in the TX ring and drained by the TX half-empty
+ * interrupt; the caller sleeps until the last byte has been handed to
+ * the hardware FIFO. Not reentrant - one sender only.
  *
  * @param data Pointer to data buffer
- * @param length Number of data bytes (1-MAX_DATA_LENGTH)
- * @param timeout_ms Timeout for each byte transmission
+ * @param length Number of data bytes (1-uart_link_max_length())
+ * @param timeout_ms Timeout for the whole frame
  * @return 0 on success, -1 on invalid length or timeout
  */
-int uart_send_frame_with_timeout(const uint8_t* data, uint8_t length, uint32_t timeout_ms) {
-    if (length == 0 || length > MAX_DATA_LENGTH) {
+int uart_send_frame_with_timeout(const uint8_t* data, uint16_t length, uint32_t timeout_ms) {
+    if (length == 0 || length > uart_link_max_length()) {
         return -1;  // Invalid length
     }
 
-    // Calculate CRC over [length][data]
-    uint16_t crc = CRCINIT;
-    crc = crc_iterate(crc, length);
-    for (uint8_t i = 0; i < length; i++) {
-        crc = crc_iterate(crc, data[i]);
-    }
+    TickType_t deadline = xTaskGetTickCount() + pdMS_TO_TICKS(timeout_ms);
 
-    uint8_t crc_low = crc & 0xFF;
-    uint8_t crc_high = (crc >> 8) & 0xFF;
+    // The ISR wakes whichever task is sending
+    tx_task = xTaskGetCurrentTaskHandle();
 
-    // Transmit frame with timeout checks
-    if (uart_txByte_with_timeout(PROTOCOL_STX, timeout_ms) != 0) return -1;
-    if (uart_txByte_with_timeout(length, timeout_ms) != 0) return -1;
+    // Drop a stale completion from an earlier timed-out frame
+    task_signal_wait(TASK_SIGNAL_TX_DONE, 0);
 
-    for (uint8_t i = 0; i < length; i++) {
-        if (uart_txByte_with_timeout(data[i], timeout_ms) != 0) return -1;
+    int ret = link_cobs ? cobs_tx_frame(data, length, deadline)
+                        : legacy_tx_frame(data, length, deadline);
+    if (ret != 0) {
+        return -1;  // Timeout
     }
 
-    if (uart_txByte_with_timeout(crc_low, timeout_ms) != 0) return -1;
-    if (uart_txByte_with_timeout(crc_high, timeout_ms) != 0) return -1;
-    if (uart_txByte_with_timeout(PROTOCOL_ETX, timeout_ms) != 0) return -1;
+    tx_stats.frames++;
+    tx_stats.payload_bytes += length;
+
+    // Wait for the ring to drain into the hardware FIFO
+    TickType_t now = xTaskGetTickCount();
+    TickType_t remaining = ((int32_t)(deadline - now) > 0) ? deadline - now : 0;
+    // (a completion left over from an earlier piece may wake us first)
+    while (tx_head != tx_tail) {
+        if (task_signal_wait(TASK_SIGNAL_TX_DONE, remaining) == 0) {
+            return -1;  // Timeout
+        }
+        now = xTaskGetTickCount();
+        remaining = ((int32_t)(deadline - now) > 0) ? deadline - now : 0;
+    }
 
     return 0;  // Success
 }
+
+/**
+ * @brief Largest payload that may be sent right now
+ *
+ * MAX_DATA_LENGTH until the gateway's HELLO raises it (up to
+ * UART_EXT_MAX_DATA_LENGTH).
+ */
+uint16_t uart_link_max_length(void)
+{
+    return peer_max_length;
+}
+
+/**
+ * @brief True once the gateway has agreed to COBS framing
+ */
+bool uart_link_cobs(void)
+{
+    return link_cobs;
+}
+
+/**
+ * @brief Register the handler for received payloads that are not commands
+ */
+void uart_set_bulk_handler(uart_rxBulk_cbt cb)
+{
+    uart_rxBulk_cb = cb;
+}
@@ -2,10 +2,71 @@
 #define __UART_H
 
 #include <stdint.h>
+#include <stdbool.h>
 #include "../utils/typing.h"
 
-typedef void (*uart_rxMessage_cbt)(command_type cmd);
+/*
+ * Frame payload limits, shared by every buffer on the link.
+ * Short frames carry a one-byte length. Extended frames (16-bit length)
+ * are for diagnostics, snapshots and configuration blobs; the receiver
+ * allocates them per frame, and a sender may only use them up to the
+ * size the peer announced in its HELLO.
+ */
+#define UART_MAX_DATA_LENGTH     255
+#define UART_EXT_MAX_DATA_LENGTH 2048
+
+/*
+ * Link capabilities offered in the session HELLO.
+ * COBS: zero-delimited, byte-stuffed framing. Used in both directions
+ * once the gateway's HELLO reply accepts it; STX/ETX until then.
+ */
+#define UART_LINK_CAP_COBS 0x01
+#define UART_LINK_CAPS     UART_LINK_CAP_COBS
+
+/***** RX interrupt statistics *****/
+typedef struct uart_rx_stats {
+    uint32_t isr_entries;      // UART0_Handler entries (RX and TX)
+    uint32_t rx_entries;       // Entries caused by the RX threshold
+    uint32_t timeout_entries;  // RX idle timer (TMR2) drains
+    uint32_t rx_bytes;         // Bytes read out of the RX FIFO
+    uint32_t max_batch;        // Most bytes drained in one entry
+    uint32_t overruns;         // RX FIFO overflowed before it was drained
+    uint32_t dropped;          // Bytes lost because the RX stream buffer was full
+    uint32_t ext_alloc_failures; // Extended frames dropped for lack of a buffer
+    uint32_t cobs_errors;      // COBS packets dropped (bad encoding, length or CRC)
+} uart_rx_stats;
+
+/***** TX framing statistics (goodput = payload_bytes / wire_bytes) *****/
+typedef struct uart_tx_stats {
+    uint32_t frames;           // Frames sent (either framing)
+    uint32_t cobs_frames;      // ... of which COBS
+    uint32_t payload_bytes;    // Caller data
+    uint32_t wire_bytes;       // Bytes handed to the UART, framing included
+} uart_tx_stats;
+
+typedef void (*uart_rxMessage_cbt)(command_type cmd, uint8_t arg);
+// Payloads that are not commands; data is only valid during the call
+typedef void (*uart_rxBulk_cbt)(const uint8_t* data, uint16_t length);
 void uart_init(uart_rxMessage_cbt uart_rxMessage_cb);
-int uart_send_frame_with_timeout(const uint8_t* data, uint8_t length, uint32_t timeout_ms);
+int uart_send_frame_with_timeout(const uint8_t* data, uint16_t length, uint32_t timeout_ms);
+
+// Largest payload the gateway currently accepts (raised by its HELLO)
+uint16_t uart_link_max_length(void);
+
+// True once the gateway has agreed to COBS framing
+bool uart_link_cobs(void);
+
+void uart_set_bulk_handler(uart_rxBulk_cbt cb);
+
+/*
+ * Link task: deframes bytes queued by the UART ISR, checks the CRC and
+ * delivers commands / ACKs to the registered callbacks.
+ */
+void uart_link_task(void *pvParameters);
+
+// Bytes per RX interrupt = rx_bytes / (rx_entries + timeout_entries)
+void uart_get_rx_stats(uart_rx_stats *stats);
+
+void uart_get_tx_stats(uart_tx_stats *stats);
 
 #endif
@@ -0,0 +1,161 @@
+#include "cloud_buffer.h"
+
+#include <string.h>
+#include "task.h"
+#include "semphr.h"
+#include "queues.h"
+
+// Ring of CLOUD_QUEUE_LENGTH updates, oldest at head. Guarded by a critical section.
+static cloud_update_event entries[CLOUD_QUEUE_LENGTH];
+static uint8_t head = 0;
+static uint8_t count = 0;
+
+// Given on every publish so the cloud task can sleep on an empty buffer
+static SemaphoreHandle_t ready_sem = NULL;
+static StaticSemaphore_t ready_sem_buffer;
+
+static cloud_buffer_stats stats;
+
+
+/***** Helpers (caller holds the critical section) *****/
+static cloud_update_event *entry(uint8_t i)
+{
+    return &entries[(head + i) % CLOUD_QUEUE_LENGTH];
+}
+
+static bool is_critical(const cloud_update_event *update)
+{
+    return update->state == ALERT || update->state == ALARM;
+}
+
+// Remove entry i, closing the gap by moving the newer entries back
+static void remove_at(uint8_t i)
+{
+    for (; i + 1 < count; i++) {
+        *entry(i) = *entry(i + 1);
+    }
+    count--;
+}
+
+static void append(const cloud_update_event *update)
+{
+    *entry(count) = *update;
+    count++;
+    stats.published++;
+    if (count > stats.high_water) {
+        stats.high_water = count;
+    }
+}
+
+/*
+ * Frees one slot for update by priority (see cloud_buffer.h).
+ * Returns false if nothing may be removed.
+ */
+static bool make_room(const cloud_update_event *update)
+{
+    // 1. A low-priority state directly superseded by another one
+    for (uint8_t i = 0; i < count; i++) {
+        const cloud_update_event *next = (i + 1 < count) ? entry(i + 1) : update;
+        if (!is_critical(entry(i)) && !is_critical(next)) {
+            remove_at(i);
+            stats.collapsed++;
+            return true;
+        }
+    }
+
+    // 2. The oldest low-priority update
+    for (uint8_t i = 0; i < count; i++) {
+        if (!is_critical(entry(i))) {
+            remove_at(i);
+            stats.evicted++;
+            return true;
+        }
+    }
+
+    // 3. Everything buffered is ALERT/ALARM
+    if (is_critical(update)) {
+        stats.critical_drops++;
+    } else {
+        stats.dropped++;
+    }
+    return false;
+}
+
+
+/***** API *****/
+void cloud_buffer_init(void)
+{
+    ready_sem = xSemaphoreCreateBinaryStatic(&ready_sem_buffer);
+}
+
+bool cloud_buffer_push(const cloud_update_event *update)
+{
+    bool ok = false;
+
+    taskENTER_CRITICAL();
+    if (count < CLOUD_QUEUE_LENGTH) {
+        append(update);
+        ok = true;
+    }
+    taskEXIT_CRITICAL();
+
+    if (ok) {
+        xSemaphoreGive(ready_sem);
+    }
+    return ok;
+}
+
+bool cloud_buffer_publish(const cloud_update_event *update)
+{
+    bool ok = true;
+
+    taskENTER_CRITICAL();
+    if (count == CLOUD_QUEUE_LENGTH) {
+        ok = make_room(update);
+    }
+    if (ok) {
+        append(update);
+    }
+    taskEXIT_CRITICAL();
+
+    if (ok) {
+        xSemaphoreGive(ready_sem);
+    }
+    return ok;
+}
+
+bool cloud_buffer_pop(cloud_update_event *update, TickType_t wait)
+{
+    bool ok = false;
+
+    // The semaphore may be stale (given for an update already taken), so
+    // an empty buffer after waking just reports nothing this time round
+    for (int attempt = 0; attempt < 2 && !ok; attempt++) {
+        taskENTER_CRITICAL();
+        if (count > 0) {
+            *update = entries[head];
+            head = (head + 1) % CLOUD_QUEUE_LENGTH;
+            count--;
+            ok = true;
+        }
+        taskEXIT_CRITICAL();
+
+        if (ok || wait == 0 || xSemaphoreTake(ready_sem, wait) != pdPASS) {
+            break;
+        }
+    }
+
+    return ok;
+}
+
+uint32_t cloud_buffer_count(void)
+{
+    return count;
+}
+
+void cloud_buffer_get_stats(cloud_buffer_stats *out)
+{
+    taskENTER_CRITICAL();
+    *out = stats;
+    taskEXIT_CRITICAL();
+}
@@ -0,0 +1,51 @@
+#ifndef CLOUD_BUFFER_H
+#define CLOUD_BUFFER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "FreeRTOS.h"
+#include "typing.h"
+
+/*
+ * RAM buffer of cloud updates between AlertControlTask and the cloud task
+ * (replaces the plain cloud_update_queue).
+ *
+ * Updates leave in the order they were published. Nothing here ever
+ * blocks the publisher. When the buffer is full, room is made by priority
+ * rather than by age:
+ *   1. collapse - drop the oldest low-priority update that is directly
+ *      followed by another low-priority update (a state the gateway
+ *      would only have seen for a moment)
+ *   2. evict    - drop the oldest low-priority update
+ *   3. drop     - the buffer is all ALERT/ALARM: a low-priority newcomer
+ *      is dropped; an ALERT/ALARM newcomer is dropped and counted in
+ *      critical_drops (the flash log takes the overflow long before this)
+ * ALERT and ALARM updates already in the buffer are never removed.
+ */
+
+typedef struct cloud_buffer_stats {
+    uint32_t published;       // Updates accepted
+    uint32_t collapsed;       // Superseded low-priority updates removed
+    uint32_t evicted;         // Other low-priority updates removed
+    uint32_t dropped;         // Low-priority newcomers dropped
+    uint32_t critical_drops;  // ALERT/ALARM newcomers dropped
+    uint32_t high_water;      // Most updates buffered at once
+} cloud_buffer_stats;
+
+// Create the buffer (before the scheduler, from init_queues)
+void cloud_buffer_init(void);
+
+// Append if there is room. Never blocks, never evicts.
+bool cloud_buffer_push(const cloud_update_event *update);
+
+// Append, making room by priority if full. Returns false if the update was dropped.
+bool cloud_buffer_publish(const cloud_update_event *update);
+
+// Oldest update, waiting up to wait ticks. Cloud task only.
+bool cloud_buffer_pop(cloud_update_event *update, TickType_t wait);
+
+uint32_t cloud_buffer_count(void);
+
+void cloud_buffer_get_stats(cloud_buffer_stats *stats);
+
+#endif /* CLOUD_BUFFER_H */
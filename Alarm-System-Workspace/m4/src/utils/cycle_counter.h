@@ -0,0 +1,26 @@
+#ifndef CYCLE_COUNTER_H
+#define CYCLE_COUNTER_H
+
+#include <stdint.h>
+#include "mxc_device.h"
+
+/*
+ * Cortex-M4 DWT cycle counter.
+ * Used to measure the cost of processing blocks in CPU cycles.
+ * Differences are valid across a single 32-bit wrap (~42 s at 100 MHz).
+ */
+
+// Enable the trace unit and start the cycle counter (idempotent)
+static inline void cycle_counter_init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+// Current cycle count
+static inline uint32_t cycle_counter_now(void)
+{
+    return DWT->CYCCNT;
+}
+
+#endif /* CYCLE_COUNTER_H */
@@ -0,0 +1,183 @@
+#include "event_bus.h"
+
+#include "task.h"
+#include "semphr.h"
+#include "queues.h"
+
+typedef struct bus_entry {
+    alert_event event;
+    uint32_t seq;            // Publish order, last tie-break
+    TickType_t published;    // For max_wait
+    uint8_t rank;            // 0 = dispatched first (see event_bus.h)
+    bool reserved;           // Holds the WARN timeout slot, never evicted
+} bus_entry;
+
+// Pending events sorted in dispatch order, next at [0]. Guarded by a critical section.
+static bus_entry entries[EVENT_BUS_LENGTH];
+static uint8_t count = 0;
+static uint8_t reserved_count = 0;
+static uint32_t next_seq = 0;
+
+// Counts pending events: given once per event added, taken once per dispatch
+static SemaphoreHandle_t pending_sem = NULL;
+static StaticSemaphore_t pending_sem_buffer;
+
+static event_bus_stats stats;
+
+
+/***** Helpers (caller holds the critical section) *****/
+static uint8_t rank_of(const alert_event *event)
+{
+    if (event->source == EVENT_SOURCE_MOTION) {
+        switch (event->motion.warning) {
+            case HIGH_WARN:
+                return 1;
+            case MED_WARN:
+                return 2;
+            default:
+                return 4;
+        }
+    }
+
+    return (event->command.cmd == CANCEL_WARN) ? 3 : 0;
+}
+
+// True if a is dispatched before b. Tick and seq comparisons survive wrap.
+static bool before(const bus_entry *a, const bus_entry *b)
+{
+    if (a->rank != b->rank) {
+        return a->rank < b->rank;
+    }
+    if (a->event.timestamp != b->event.timestamp) {
+        return (int32_t)(a->event.timestamp - b->event.timestamp) < 0;
+    }
+    return (int32_t)(a->seq - b->seq) < 0;
+}
+
+static void remove_at(uint8_t i)
+{
+    if (entries[i].reserved) {
+        reserved_count--;
+    }
+    for (; i + 1 < count; i++) {
+        entries[i] = entries[i + 1];
+    }
+    count--;
+}
+
+static void insert(const bus_entry *e)
+{
+    uint8_t i = count;
+
+    while (i > 0 && before(e, &entries[i - 1])) {
+        entries[i] = entries[i - 1];
+        i--;
+    }
+    entries[i] = *e;
+    count++;
+    if (e->reserved) {
+        reserved_count++;
+    }
+
+    stats.published++;
+    if (count > stats.high_water) {
+        stats.high_water = count;
+    }
+}
+
+// Last (lowest-ranked, newest) entry an ordinary event may evict, or -1
+static int victim(void)
+{
+    for (int i = count - 1; i >= 0; i--) {
+        if (!entries[i].reserved) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static bool publish(const alert_event *event, bool reserved)
+{
+    bus_entry e = {
+        .event = *event,
+        .rank = rank_of(event),
+        .published = xTaskGetTickCount()
+    };
+    bool ok = true;
+    bool evicted = false;
+
+    taskENTER_CRITICAL();
+    e.seq = next_seq++;
+    e.reserved = reserved && reserved_count < EVENT_BUS_RESERVED;
+
+    if (!e.reserved && count - reserved_count >= EVENT_BUS_LENGTH - EVENT_BUS_RESERVED) {
+        int v = victim();
+        if (v >= 0 && before(&e, &entries[v])) {
+            remove_at((uint8_t)v);
+            stats.evicted++;
+            evicted = true;
+        } else {
+            stats.dropped++;
+            ok = false;
+        }
+    }
+    if (ok) {
+        insert(&e);
+    }
+    taskEXIT_CRITICAL();
+
+    // An eviction swaps one pending event for another: the count is unchanged
+    if (ok && !evicted) {
+        xSemaphoreGive(pending_sem);
+    }
+    return ok;
+}
+
+
+/***** API *****/
+void event_bus_init(void)
+{
+    pending_sem = xSemaphoreCreateCountingStatic(EVENT_BUS_LENGTH, 0, &pending_sem_buffer);
+}
+
+bool event_bus_publish(const alert_event *event)
+{
+    return publish(event, false);
+}
+
+bool event_bus_publish_reserved(const alert_event *event)
+{
+    return publish(event, true);
+}
+
+bool event_bus_wait(alert_event *event, TickType_t wait)
+{
+    if (xSemaphoreTake(pending_sem, wait) != pdPASS) {
+        return false;
+    }
+
+    TickType_t now = xTaskGetTickCount();
+
+    taskENTER_CRITICAL();
+    *event = entries[0].event;
+    if (now - entries[0].published > stats.max_wait) {
+        stats.max_wait = now - entries[0].published;
+    }
+    remove_at(0);
+    stats.dispatched++;
+    taskEXIT_CRITICAL();
+
+    return true;
+}
+
+uint32_t event_bus_count(void)
+{
+    return count;
+}
+
+void event_bus_get_stats(event_bus_stats *out)
+{
+    taskENTER_CRITICAL();
+    *out = stats;
+    taskEXIT_CRITICAL();
+}
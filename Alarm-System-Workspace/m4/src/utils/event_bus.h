@@ -0,0 +1,58 @@
+#ifndef EVENT_BUS_H
+#define EVENT_BUS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "FreeRTOS.h"
+#include "typing.h"
+
+/*
+ * Single priority-ordered bus of alert_events into AlertControlTask
+ * (replaces motion_queue, command_queue and the queue set over them).
+ *
+ * Events are dispatched by rank, then by timestamp, then in publish order,
+ * so the same set of pending events always comes out in the same order:
+ *   0. operator commands (ARM, DISARM, RESOLVE_ALARM)
+ *   1. HIGH_WARN
+ *   2. MED_WARN
+ *   3. CANCEL_WARN (escalation wins over the WARN timeout)
+ *   4. LOW_WARN    (after any pending CANCEL_WARN, so it can't be undone by it)
+ *
+ * Publishing never blocks. When the bus is full the lowest-ranked, newest
+ * event is evicted if the newcomer outranks it; otherwise the newcomer is
+ * dropped. Both are counted.
+ *
+ * One slot is held back for the WARN timeout: the timer can have at most
+ * one CANCEL_WARN pending (WARN is only re-entered through a LOW_WARN,
+ * which is dispatched after it), so event_bus_publish_reserved() always
+ * finds room and that event is never evicted.
+ */
+
+#define EVENT_BUS_RESERVED 1
+
+typedef struct event_bus_stats {
+    uint32_t published;      // Events accepted
+    uint32_t dispatched;     // Events handed to the consumer
+    uint32_t evicted;        // Lower-ranked events removed for a newcomer
+    uint32_t dropped;        // Newcomers dropped on a full bus
+    uint32_t high_water;     // Most events pending at once
+    uint32_t max_wait;       // Longest publish -> dispatch time (ticks)
+} event_bus_stats;
+
+// Create the bus (before the scheduler, from init_queues)
+void event_bus_init(void);
+
+// Task context, never blocks. Returns false if the event was dropped.
+bool event_bus_publish(const alert_event *event);
+
+// As above, into the held-back slot. WARN timeout callback only.
+bool event_bus_publish_reserved(const alert_event *event);
+
+// Next event in dispatch order, waiting up to wait ticks. AlertControlTask only.
+bool event_bus_wait(alert_event *event, TickType_t wait);
+
+uint32_t event_bus_count(void);
+
+void event_bus_get_stats(event_bus_stats *stats);
+
+#endif /* EVENT_BUS_H */
@@ -0,0 +1,412 @@
+#include "flash_log.h"
+
+#include <string.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+#include "mxc_device.h"
+#include "flc.h"
+#include "timestamp.h"
+#include "../uart/crc16.h"
+
+/*
+ * Log area: the last FLASH_LOG_PAGES pages of flash, kept out of the
+ * image by memory.ld. Records are 16 bytes, one 128-bit flash write each.
+ *
+ * Two record types share the ring:
+ *   UPDATE   - one cloud update
+ *   CONSUMED - "every update up to seq N has been replayed"
+ * Record seq numbers increase by one per record across the whole ring,
+ * so after a reset the newest record marks the write position and the
+ * newest CONSUMED marker tells where replay resumes.
+ */
+#define LOG_BASE     (MXC_FLASH_MEM_BASE + MXC_FLASH_MEM_SIZE - FLASH_LOG_PAGES * MXC_FLASH_PAGE_SIZE)
+#define LOG_END      (MXC_FLASH_MEM_BASE + MXC_FLASH_MEM_SIZE)
+#define RECORD_SIZE  16
+#define ERASED_WORD  0xFFFFFFFFu
+
+#define RECORD_UPDATE    0x01
+#define RECORD_CONSUMED  0x02
+
+#define SPILL_QUEUE_LENGTH  8
+#define SPILL_RESERVED      4     // Queue slots only ALERT/ALARM updates may take
+#define CRITICAL_SPILL_WAIT_MS 100 // Longest wait for a slot (covers a page erase)
+#define MARKER_INTERVAL     32    // Replayed updates between CONSUMED markers
+#define MARKER_POLL_MS      1000  // Idle check for a pending marker
+
+typedef struct __attribute__((packed)) flash_log_record {
+    uint32_t seq;         // Record number (ERASED_WORD = free slot)
+    uint8_t type;         // RECORD_UPDATE / RECORD_CONSUMED
+    uint8_t flags;        // bit 0: from_motion
+    uint8_t warning;
+    uint8_t state;
+    uint8_t odr_code;
+    uint8_t device_id;
+    uint16_t check;       // CRC-16 of the record with this field zeroed
+    uint32_t value;       // UPDATE: event timestamp, CONSUMED: last replayed seq
+} flash_log_record;
+
+_Static_assert(sizeof(flash_log_record) == RECORD_SIZE, "record must be one flash line");
+
+static QueueHandle_t spill_queue = NULL;
+static StaticQueue_t spill_queue_struct;
+static uint8_t spill_queue_storage[(SPILL_QUEUE_LENGTH + SPILL_RESERVED) * sizeof(cloud_update_event)];
+static SemaphoreHandle_t log_mutex = NULL;
+static StaticSemaphore_t log_mutex_buffer;
+
+// Guarded by log_mutex
+static uint32_t write_addr;       // Next slot to program
+static uint32_t next_seq;         // seq of the next record
+static uint32_t read_addr;        // Next slot to look at when replaying
+static uint32_t consumed_seq;     // Newest update seq handed to the cloud task
+static uint32_t persisted_seq;    // consumed_seq as last recorded in flash
+static volatile uint32_t readable;
+
+// Updates spilled and not yet replayed (or lost) - keeps ordering
+static volatile uint32_t backlog = 0;
+
+static flash_log_stats stats;
+
+
+/***** Record helpers *****/
+static uint32_t next_addr(uint32_t addr)
+{
+    addr += RECORD_SIZE;
+    return (addr >= LOG_END) ? LOG_BASE : addr;
+}
+
+static uint16_t record_check(const flash_log_record *rec)
+{
+    flash_log_record tmp = *rec;
+    tmp.check = 0;
+    return crc16_compute((const uint8_t *)&tmp, sizeof(tmp));
+}
+
+static const flash_log_record *record_at(uint32_t addr)
+{
+    return (const flash_log_record *)addr;
+}
+
+// Valid = programmed completely (a torn write fails the check)
+static bool record_valid(const flash_log_record *rec)
+{
+    return rec->seq != ERASED_WORD && rec->check == record_check(rec);
+}
+
+static bool slot_erased(uint32_t addr)
+{
+    const uint32_t *w = (const uint32_t *)addr;
+    return w[0] == ERASED_WORD && w[1] == ERASED_WORD &&
+           w[2] == ERASED_WORD && w[3] == ERASED_WORD;
+}
+
+static bool is_unread_update(const flash_log_record *rec)
+{
+    return record_valid(rec) && rec->type == RECORD_UPDATE && rec->seq > consumed_seq;
+}
+
+
+/***** Initialisation *****/
+void flash_log_init(void)
+{
+    uint32_t max_seq = 0, max_addr = LOG_BASE;
+    uint32_t marker_seq = 0;
+    bool any = false;
+
+    MXC_FLC_Init();
+
+    consumed_seq = 0;
+
+    // Newest record = write position, newest marker = replay position
+    for (uint32_t addr = LOG_BASE; addr < LOG_END; addr += RECORD_SIZE) {
+        const flash_log_record *rec = record_at(addr);
+        if (!record_valid(rec)) {
+            continue;
+        }
+
+        if (!any || rec->seq > max_seq) {
+            max_seq = rec->seq;
+            max_addr = addr;
+            any = true;
+        }
+
+        if (rec->type == RECORD_CONSUMED && rec->seq >= marker_seq) {
+            marker_seq = rec->seq;
+            consumed_seq = rec->value;
+        }
+    }
+
+    write_addr = any ? next_addr(max_addr) : LOG_BASE;
+    next_seq = any ? max_seq + 1 : 1;
+    persisted_seq = consumed_seq;
+
+    // Replay resumes at the oldest update newer than the marker
+    uint32_t oldest = ERASED_WORD;
+    readable = 0;
+    read_addr = write_addr;
+
+    for (uint32_t addr = LOG_BASE; addr < LOG_END; addr += RECORD_SIZE) {
+        const flash_log_record *rec = record_at(addr);
+        if (is_unread_update(rec)) {
+            readable++;
+            if (rec->seq < oldest) {
+                oldest = rec->seq;
+                read_addr = addr;
+            }
+        }
+    }
+
+    backlog = readable;
+
+    spill_queue = xQueueCreateStatic(SPILL_QUEUE_LENGTH + SPILL_RESERVED, sizeof(cloud_update_event),
+                                     spill_queue_storage, &spill_queue_struct);
+    log_mutex = xSemaphoreCreateMutexStatic(&log_mutex_buffer);
+}
+
+
+/***** Writing (FlashLogTask only) *****/
+/*
+ * Erases the page starting at addr. Updates in it that were never
+ * replayed are lost; replay skips ahead to the next page.
+ * Caller holds log_mutex.
+ */
+static int erase_page(uint32_t addr)
+{
+    uint32_t page_end = addr + MXC_FLASH_PAGE_SIZE;
+
+    if (readable > 0) {
+        uint32_t lost = 0;
+        for (uint32_t a = addr; a < page_end; a += RECORD_SIZE) {
+            const flash_log_record *rec = record_at(a);
+            if (is_unread_update(rec)) {
+                lost++;
+                if (rec->seq > consumed_seq) {
+                    consumed_seq = rec->seq;
+                }
+            }
+        }
+
+        if (lost > 0) {
+            readable -= lost;
+            stats.overwritten += lost;
+
+            taskENTER_CRITICAL();
+            backlog -= lost;
+            taskEXIT_CRITICAL();
+        }
+
+        if (read_addr >= addr && read_addr < page_end) {
+            read_addr = (page_end >= LOG_END) ? LOG_BASE : page_end;
+        }
+    }
+
+    stats.erases++;
+    return MXC_FLC_PageErase(addr);
+}
+
+/*
+ * Programs one record at the write position, erasing the page first
+ * when the ring wraps onto it.
+ */
+static int log_append(flash_log_record *rec)
+{
+    int ret = E_NO_ERROR;
+
+    xSemaphoreTake(log_mutex, portMAX_DELAY);
+
+    // Skip slots left dirty by a write that was cut short by a reset
+    while ((write_addr % MXC_FLASH_PAGE_SIZE) != 0 && !slot_erased(write_addr)) {
+        write_addr = next_addr(write_addr);
+    }
+
+    if ((write_addr % MXC_FLASH_PAGE_SIZE) == 0 && !slot_erased(write_addr)) {
+        ret = erase_page(write_addr);
+    }
+
+    if (ret == E_NO_ERROR) {
+        rec->seq = next_seq;
+        rec->check = record_check(rec);
+
+        uint32_t line[4];
+        memcpy(line, rec, sizeof(line));
+        ret = MXC_FLC_Write128(write_addr, line);
+
+        if (ret == E_NO_ERROR && memcmp((const void *)write_addr, rec, RECORD_SIZE) != 0) {
+            ret = E_BAD_STATE;
+        }
+    }
+
+    if (ret == E_NO_ERROR) {
+        next_seq++;
+        if (rec->type == RECORD_UPDATE) {
+            readable++;
+        }
+    } else {
+        stats.write_errors++;
+    }
+
+    // A failed slot is not retried
+    write_addr = next_addr(write_addr);
+
+    xSemaphoreGive(log_mutex);
+    return ret;
+}
+
+// Record how far replay has got, without writing a marker per update
+static void maybe_write_marker(void)
+{
+    xSemaphoreTake(log_mutex, portMAX_DELAY);
+    uint32_t consumed = consumed_seq;
+    bool due = consumed != persisted_seq &&
+               (readable == 0 || consumed - persisted_seq >= MARKER_INTERVAL);
+    xSemaphoreGive(log_mutex);
+
+    if (!due) {
+        return;
+    }
+
+    flash_log_record rec = {0};
+    rec.type = RECORD_CONSUMED;
+    rec.value = consumed;
+
+    if (log_append(&rec) == E_NO_ERROR) {
+        persisted_seq = consumed;
+    }
+}
+
+void FlashLogTask(void *arg)
+{
+    cloud_update_event update;
+
+    while (1) {
+        if (xQueueReceive(spill_queue, &update, pdMS_TO_TICKS(MARKER_POLL_MS)) == pdPASS) {
+            flash_log_record rec = {0};
+            rec.type = RECORD_UPDATE;
+            rec.flags = update.from_motion ? 0x01 : 0;
+            rec.warning = (uint8_t)update.warning;
+            rec.state = (uint8_t)update.state;
+            rec.odr_code = update.odr_code;
+            rec.device_id = update.device_id;
+            rec.value = update.timestamp;
+
+            uint32_t start = timestamp_now();
+            int ret = log_append(&rec);
+            uint32_t us = timestamp_ticks_to_us(timestamp_now() - start);
+
+            if (ret == E_NO_ERROR) {
+                stats.written++;
+            } else {
+                // Never made it to flash - release its place in the backlog
+                taskENTER_CRITICAL();
+                backlog--;
+                taskEXIT_CRITICAL();
+            }
+
+            if (us > stats.max_write_us) {
+                stats.max_write_us = us;
+            }
+        }
+
+        maybe_write_marker();
+    }
+}
+
+
+/***** Producer side (AlertControlTask) *****/
+bool flash_log_active(void)
+{
+    return backlog > 0;
+}
+
+/*
+ * Ordinary updates leave the last SPILL_RESERVED queue slots free, so an
+ * ALERT/ALARM update still finds room while the writer is busy erasing.
+ * If even those are taken it waits for the writer rather than being lost.
+ * AlertControlTask is the only sender, so the space check cannot race.
+ */
+bool flash_log_spill(const cloud_update_event *update)
+{
+    bool critical = (update->state == ALERT || update->state == ALARM);
+    bool queued = false;
+
+    if (spill_queue != NULL) {
+        if (critical) {
+            queued = xQueueSend(spill_queue, update, pdMS_TO_TICKS(CRITICAL_SPILL_WAIT_MS)) == pdPASS;
+        } else if (uxQueueSpacesAvailable(spill_queue) > SPILL_RESERVED) {
+            queued = xQueueSend(spill_queue, update, 0) == pdPASS;
+        }
+    }
+
+    if (!queued) {
+        stats.spill_drops++;
+        if (critical) {
+            stats.critical_spill_drops++;
+        }
+        return false;
+    }
+
+    taskENTER_CRITICAL();
+    backlog++;
+    taskEXIT_CRITICAL();
+
+    stats.spilled++;
+    return true;
+}
+
+
+/***** Consumer side (cloud task) *****/
+bool flash_log_read(cloud_update_event *update)
+{
+    bool found = false;
+
+    if (readable == 0) {
+        return false;
+    }
+
+    xSemaphoreTake(log_mutex, portMAX_DELAY);
+
+    while (!found && read_addr != write_addr) {
+        const flash_log_record *rec = record_at(read_addr);
+        read_addr = next_addr(read_addr);
+
+        if (!is_unread_update(rec)) {
+            continue;  // Marker, torn write or already replayed
+        }
+
+        memset(update, 0, sizeof(*update));
+        update->from_motion = rec->flags & 0x01;
+        update->warning = (warn_type)rec->warning;
+        update->state = (alarm_state)rec->state;
+        update->odr_code = rec->odr_code;
+        update->device_id = rec->device_id;
+        update->timestamp = rec->value;
+
+        consumed_seq = rec->seq;
+        readable--;
+        found = true;
+    }
+
+    xSemaphoreGive(log_mutex);
+
+    if (found) {
+        taskENTER_CRITICAL();
+        backlog--;
+        taskEXIT_CRITICAL();
+        stats.replayed++;
+    }
+
+    return found;
+}
+
+uint32_t flash_log_readable(void)
+{
+    return readable;
+}
+
+void flash_log_get_stats(flash_log_stats *out)
+{
+    taskENTER_CRITICAL();
+    *out = stats;
+    taskEXIT_CRITICAL();
+}
@@ -0,0 +1,60 @@
+#ifndef FLASH_LOG_H
+#define FLASH_LOG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "typing.h"
+
+/*
+ * Store-and-forward log for cloud updates.
+ *
+ * When the cloud buffer is full (gateway unreachable) new updates are
+ * spilled into an append-only ring of 16-byte records in the last
+ * FLASH_LOG_PAGES pages of internal flash. Pages are erased only when
+ * the write position wraps onto them, so every page sees the same
+ * number of erase cycles.
+ *
+ * Ordering: once an update has been spilled, every later update is
+ * spilled too until the cloud task has replayed the whole backlog, so
+ * the gateway always sees updates in the order they were produced.
+ *
+ * All flash programming happens in FlashLogTask. The AlertControlTask
+ * side (flash_log_spill) only does a queue send, which blocks briefly for
+ * ALERT/ALARM updates alone (they also have reserved queue slots).
+ */
+
+#define FLASH_LOG_PAGES 4
+
+typedef struct flash_log_stats {
+    uint32_t spilled;        // Updates handed to the log
+    uint32_t written;        // Update records programmed
+    uint32_t replayed;       // Updates read back by the cloud task
+    uint32_t overwritten;    // Unsent updates lost when the ring wrapped
+    uint32_t spill_drops;    // Spill queue full - update lost
+    uint32_t critical_spill_drops; // ... of which ALERT/ALARM updates (reserve full, writer stuck)
+    uint32_t erases;         // Page erases
+    uint32_t write_errors;   // Failed program / erase operations
+    uint32_t max_write_us;   // Slowest record program (incl. erase)
+} flash_log_stats;
+
+// Scan the log area and rebuild the write / replay positions (before the scheduler)
+void flash_log_init(void);
+
+// Flash writer task
+void FlashLogTask(void *arg);
+
+// True while updates must go through the log to stay in order
+bool flash_log_active(void);
+
+// Queue an update for the log (ALERT/ALARM may wait briefly). Returns false if it was dropped.
+bool flash_log_spill(const cloud_update_event *update);
+
+// Next logged update, oldest first. Cloud task only.
+bool flash_log_read(cloud_update_event *update);
+
+// Updates written to flash and not yet read back
+uint32_t flash_log_readable(void);
+
+void flash_log_get_stats(flash_log_stats *stats);
+
+#endif /* FLASH_LOG_H */
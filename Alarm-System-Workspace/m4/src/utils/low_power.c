@@ -0,0 +1,104 @@
+#include "low_power.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "mxc_device.h"
+#include "lp.h"
+#include "timestamp.h"
+#include <stdbool.h>
+#include <string.h>
+
+/*
+ * ============================================================================
+ * Tickless idle / sleep accounting
+ * ============================================================================
+ * SLEEP (not DEEPSLEEP) is used: the peripheral clocks keep running,
+ * so UART0 keeps receiving, the SPI/DMA engines and TMR1 timestamps
+ * stay valid, and the SysTick based tickless port keeps time.
+ *
+ * The hooks run with interrupts masked by the port. A pending
+ * interrupt still ends WFI; its handler runs once the port unmasks.
+ */
+
+static alarm_state current_state = DISARMED;
+static uint32_t state_entered_ts = 0;
+static uint32_t sleep_entered_ts = 0;
+
+// Wake-up waiting for its first event (cleared by low_power_mark_event)
+static volatile bool wake_pending = false;
+static volatile uint32_t last_wake_ts = 0;
+
+static low_power_stats stats;
+
+
+/***** Accounting helpers *****/
+/*
+ * TMR1 wraps every ~22 minutes, so the running state period is folded
+ * into the totals on every sleep as well as on state changes.
+ */
+static void fold_state_time(uint32_t now)
+{
+    stats.state[current_state].total_us += timestamp_ticks_to_us(now - state_entered_ts);
+    state_entered_ts = now;
+}
+
+void low_power_set_state(alarm_state state)
+{
+    if (state > ALARM)
+        return;
+
+    taskENTER_CRITICAL();
+    fold_state_time(timestamp_now());
+    current_state = state;
+    taskEXIT_CRITICAL();
+}
+
+void low_power_mark_event(void)
+{
+    taskENTER_CRITICAL();
+    if (wake_pending) {
+        uint32_t us = timestamp_ticks_to_us(timestamp_now() - last_wake_ts);
+        stats.last_wake_to_event_us = us;
+        if (us > stats.max_wake_to_event_us)
+            stats.max_wake_to_event_us = us;
+        wake_pending = false;
+    }
+    taskEXIT_CRITICAL();
+}
+
+void low_power_get_stats(low_power_stats *out)
+{
+    taskENTER_CRITICAL();
+    fold_state_time(timestamp_now());
+    *out = stats;
+    taskEXIT_CRITICAL();
+}
+
+
+/***** FreeRTOS tickless hooks *****/
+/*
+ * Enters SLEEP directly and reports an idle time of 0 back to the port,
+ * which then skips its own WFI but still corrects the tick count from
+ * SysTick.
+ */
+void vPreSleepProcessing(uint32_t *idle_time)
+{
+    sleep_entered_ts = timestamp_now();
+
+    MXC_LP_EnterSleepMode();
+
+    *idle_time = 0;
+}
+
+void vPostSleepProcessing(uint32_t idle_time)
+{
+    (void)idle_time;
+
+    uint32_t now = timestamp_now();
+
+    stats.state[current_state].sleep_us += timestamp_ticks_to_us(now - sleep_entered_ts);
+    stats.state[current_state].sleeps++;
+    fold_state_time(now);
+
+    last_wake_ts = now;
+    wake_pending = true;
+}
@@ -0,0 +1,47 @@
+#ifndef LOW_POWER_H
+#define LOW_POWER_H
+
+#include <stdint.h>
+#include "typing.h"
+
+/*
+ * Tickless idle support.
+ *
+ * When FreeRTOS has nothing to run it calls the pre/post sleep hooks
+ * (configPRE_SLEEP_PROCESSING / configPOST_SLEEP_PROCESSING). The core
+ * is put into SLEEP mode, where every enabled interrupt is a wake
+ * source - GPIO1 (ADXL343 INT1) and UART0 RX included.
+ *
+ * Sleep time is accounted against the current alarm state so sleep
+ * residency can be read back on the running system.
+ */
+
+typedef struct low_power_state_stats {
+    uint64_t total_us;   // Time spent in this alarm state
+    uint64_t sleep_us;   // Part of it spent asleep
+    uint32_t sleeps;     // Number of sleep periods
+} low_power_state_stats;
+
+typedef struct low_power_stats {
+    low_power_state_stats state[ALARM + 1];
+    uint32_t last_wake_to_event_us;  // Wake-up to first event handled
+    uint32_t max_wake_to_event_us;
+} low_power_stats;
+
+// Called by AlertControlTask on every state change
+void low_power_set_state(alarm_state state);
+
+/*
+ * Marks the first event handled after a wake-up (motion interrupt,
+ * UART command). Measures wake-up-to-event latency. Task context only.
+ */
+void low_power_mark_event(void);
+
+// Snapshot of residency per state (includes the running period)
+void low_power_get_stats(low_power_stats *stats);
+
+// FreeRTOS tickless idle hooks (see FreeRTOSConfig.h)
+void vPreSleepProcessing(uint32_t *idle_time);
+void vPostSleepProcessing(uint32_t idle_time);
+
+#endif /* LOW_POWER_H */
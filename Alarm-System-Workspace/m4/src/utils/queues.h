@@ -3,16 +3,11 @@
 
 #include "queue.h"
 
-#define MOTION_QUEUE_LENGTH 10
-#define COMMAND_QUEUE_LENGTH 10
-#define CLOUD_QUEUE_LENGTH 20 // Can get backed up if no connectivity
+#define EVENT_BUS_LENGTH 20 // Motion and command events together (see event_bus.h)
+#define CLOUD_QUEUE_LENGTH 20 // Can get backed up if no connectivity (see cloud_buffer.h)
 
-// motion_events sent from motion task -> handled by alert controller task, state updated as needed
-extern QueueHandle_t motion_queue;
-// command_events sent from cloud task -> handled by alert controller task, state updated as needed
-extern QueueHandle_t command_queue;
-// cloud_update_events sent from alert controller task based on any state update -> handled by cloud task
-extern QueueHandle_t cloud_update_queue;
+// alert_events (motion task, cloud task, WARN timeout) -> alert controller task go through event_bus.h
+// cloud_update_events from alert controller task -> cloud task go through cloud_buffer.h
 
 // Initialize queues to corresponding lengths
 void init_queues(void);
@@ -0,0 +1,99 @@
+#include "spsc_ring.h"
+
+#include <string.h>
+
+/*
+ * head and tail are free-running counters; the slot is index & (capacity - 1)
+ * and head - tail is the fill level, which stays correct across wrap.
+ *
+ * Ordering: the producer copies the element before publishing head
+ * (release) and the consumer reads head (acquire) before copying it out;
+ * the same pairing on tail keeps the producer from reusing a slot that
+ * is still being read. On the Cortex-M4 these compile to plain loads and
+ * stores with a DMB.
+ */
+
+static spsc_ring *registry = NULL;
+
+
+void spsc_ring_init(spsc_ring *ring, const char *name, void *storage,
+                    uint16_t elem_size, uint16_t capacity)
+{
+    ring->name = name;
+    ring->storage = storage;
+    ring->elem_size = elem_size;
+    ring->capacity = capacity;
+    ring->head = 0;
+    ring->tail = 0;
+    ring->pushed = 0;
+    ring->drops = 0;
+    ring->high_water = 0;
+
+    // Register once - a re-initialised ring is already on the list
+    for (spsc_ring *r = registry; r != NULL; r = r->next) {
+        if (r == ring) {
+            return;
+        }
+    }
+    ring->next = registry;
+    registry = ring;
+}
+
+bool spsc_ring_push(spsc_ring *ring, const void *elem)
+{
+    uint32_t head = ring->head;
+    uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    uint32_t used = head - tail;
+
+    if (used >= ring->capacity) {
+        ring->drops++;
+        return false;
+    }
+
+    memcpy(&ring->storage[(head & (ring->capacity - 1)) * ring->elem_size],
+           elem, ring->elem_size);
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+
+    ring->pushed++;
+    if (used + 1 > ring->high_water) {
+        ring->high_water = used + 1;
+    }
+    return true;
+}
+
+bool spsc_ring_pop(spsc_ring *ring, void *elem)
+{
+    uint32_t tail = ring->tail;
+    uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+
+    if (head == tail) {
+        return false;
+    }
+
+    memcpy(elem, &ring->storage[(tail & (ring->capacity - 1)) * ring->elem_size],
+           ring->elem_size);
+    __atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+uint32_t spsc_ring_count(const spsc_ring *ring)
+{
+    return __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) -
+           __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+}
+
+uint8_t spsc_ring_get_diag(spsc_ring_stats *out, uint8_t max)
+{
+    uint8_t n = 0;
+
+    for (spsc_ring *r = registry; r != NULL && n < max; r = r->next, n++) {
+        out[n].name = r->name;
+        out[n].capacity = r->capacity;
+        out[n].count = spsc_ring_count(r);
+        out[n].pushed = r->pushed;
+        out[n].drops = r->drops;
+        out[n].high_water = r->high_water;
+    }
+
+    return n;
+}
@@ -0,0 +1,58 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Lock-free single-producer / single-consumer ring of fixed-size elements.
+ *
+ * For ISR -> task hops that only need to hand over a small record: the
+ * producer (typically an ISR) only writes head, the consumer only writes
+ * tail, so neither side needs a critical section or a kernel call. Pair
+ * it with a semaphore or notification to wake the consumer.
+ *
+ * When full the new element is dropped (the producer can't touch tail)
+ * and counted. Every ring registers itself for spsc_ring_get_diag().
+ *
+ * Exactly one producer context and one consumer context per ring.
+ */
+
+typedef struct spsc_ring {
+    const char *name;
+    uint8_t *storage;            // capacity * elem_size bytes
+    uint16_t elem_size;
+    uint16_t capacity;           // Power of two
+    volatile uint32_t head;      // Written by the producer only
+    volatile uint32_t tail;      // Written by the consumer only
+    volatile uint32_t pushed;    // Producer-side counters
+    volatile uint32_t drops;
+    volatile uint32_t high_water;
+    struct spsc_ring *next;      // Diagnostics registry
+} spsc_ring;
+
+typedef struct spsc_ring_stats {
+    const char *name;
+    uint32_t capacity;
+    uint32_t count;        // Elements waiting right now
+    uint32_t pushed;       // Elements accepted
+    uint32_t drops;        // Elements dropped because the ring was full
+    uint32_t high_water;   // Most elements waiting at once
+} spsc_ring_stats;
+
+// Set up a ring over caller-provided storage (once, before either side uses it)
+void spsc_ring_init(spsc_ring *ring, const char *name, void *storage,
+                    uint16_t elem_size, uint16_t capacity);
+
+// Producer side (ISR safe). Returns false if the ring was full.
+bool spsc_ring_push(spsc_ring *ring, const void *elem);
+
+// Consumer side. Returns false if the ring was empty.
+bool spsc_ring_pop(spsc_ring *ring, void *elem);
+
+uint32_t spsc_ring_count(const spsc_ring *ring);
+
+// Counters of every registered ring; returns how many were written to out
+uint8_t spsc_ring_get_diag(spsc_ring_stats *out, uint8_t max);
+
+#endif /* SPSC_RING_H */
@@ -8,6 +8,8 @@
 #include "watchdog.h"
 #include "../motion/adxl343_motion.h"
 #include "../uart/cloud_tasks.h"
+#include "../uart/uart_coms.h"
+#include "flash_log.h"
 
 /*
  * Priorities explained (Low to High):
@@ -27,6 +29,14 @@
  *    prevents blocking while maintaining timely communication. Lower than Motion Detection to prioritize
  *    real-time sensor data capture.
  * 
+ * - UART Link Task: tskIDLE_PRIORITY + 2 deframes bytes pushed by the UART ISR and delivers
+ *    commands and ACKs. Above Cloud Send so an ACK is seen as soon as it arrives, below Motion
+ *    Detection since it only has to keep the 128-byte RX stream buffer from filling.
+ * 
+ * - Flash Log Task: Medium priority (tskIDLE_PRIORITY + 1) programs spilled cloud updates into flash while
+ *    the gateway is unreachable. A page erase stalls flash reads for tens of milliseconds, so it runs no
+ *    higher than the tasks it competes with; the UART window retransmits anything lost meanwhile.
+ * 
  * - Motion Detection Task: High priority (configMAX_PRIORITIES - 1) captures accelerometer data in real-time.
  *    Time-critical sensor sampling cannot be delayed without losing motion events. Highest priority ensures
  *    consistent sampling rates and prevents motion data loss from preemption by other tasks.
@@ -48,30 +58,78 @@
  * - Watchdog Task: 256 bytes minimal stack for simple periodic timer checks and system health flags. Task
  *    performs only basic comparisons and register updates without complex logic.
  * 
+ * - UART Link Task: 256 bytes covers the 32-byte receive chunk and the frame parser. Command
+ *    decoding is a short string compare chain with no deep calls.
+ * 
+ * - Flash Log Task: 256 bytes holds one queued update and one 16-byte record; the FLC driver calls are shallow.
+ * 
  * - Cloud Send Task: 256 bytes sufficient for UART frame construction and transmission. Minimal processing
  *    since data is already formatted by Alert Control Task. Simple send-and-wait operations do not require
  *    large local buffers or deep call stacks.
 */
 
+/*
+ * Every task is created from static storage: a stack (in words, as
+ * xTaskCreate takes it) and a TCB, each listed by `make ram-report`.
+ */
+#define TASK_STORAGE(name, depth) \
+    static StackType_t name##_stack[depth]; \
+    static StaticTask_t name##_tcb
+
+#define CREATE_TASK(name, fn, label, priority) \
+    xTaskCreateStatic(fn, label, sizeof(name##_stack) / sizeof(StackType_t), NULL, \
+                      priority, name##_stack, &name##_tcb)
+
+TASK_STORAGE(led_effects, 512);
+TASK_STORAGE(alert_control, 1024);
+TASK_STORAGE(watchdog, 256);
+TASK_STORAGE(motion_detection, 512);
+TASK_STORAGE(cloud_send, 256);
+TASK_STORAGE(uart_link, 256);
+TASK_STORAGE(flash_log, 256);
+
+// Kernel-created tasks (configSUPPORT_STATIC_ALLOCATION)
+TASK_STORAGE(idle, configMINIMAL_STACK_SIZE);
+TASK_STORAGE(timer_service, configTIMER_TASK_STACK_DEPTH);
+
+void vApplicationGetIdleTaskMemory(StaticTask_t **tcb, StackType_t **stack, uint32_t *depth) {
+    *tcb = &idle_tcb;
+    *stack = idle_stack;
+    *depth = sizeof(idle_stack) / sizeof(StackType_t);
+}
+
+void vApplicationGetTimerTaskMemory(StaticTask_t **tcb, StackType_t **stack, uint32_t *depth) {
+    *tcb = &timer_service_tcb;
+    *stack = timer_service_stack;
+    *depth = sizeof(timer_service_stack) / sizeof(StackType_t);
+}
+
 void create_LED_control_task(void) {
-    xTaskCreate(LedEffectTask, "LEDEffects", 512, NULL, tskIDLE_PRIORITY + 1,NULL);
+    CREATE_TASK(led_effects, LedEffectTask, "LEDEffects", tskIDLE_PRIORITY + 1);
 }
 
 void create_alert_control_task(void) {
-    xTaskCreate(AlertControlTask, "AlertControl", 1024, NULL, tskIDLE_PRIORITY + 1, NULL);
+    CREATE_TASK(alert_control, AlertControlTask, "AlertControl", tskIDLE_PRIORITY + 1);
 }
 
 void create_watchdog_task(void) {
-    xTaskCreate(WatchdogTask, "WDT", 256, NULL, tskIDLE_PRIORITY + 1, NULL );
-
+    CREATE_TASK(watchdog, WatchdogTask, "WDT", tskIDLE_PRIORITY + 1);
 }
 
 void create_motion_detection_task(void) {
-    xTaskCreate(MotionDetectionTask, "MotionDetect", 512, NULL, configMAX_PRIORITIES - 1, NULL);
+    CREATE_TASK(motion_detection, MotionDetectionTask, "MotionDetect", configMAX_PRIORITIES - 1);
 }
 
 void create_cloud_send_task(void) {
-    xTaskCreate(cloud_send_task, "CloudSend", 256, NULL, tskIDLE_PRIORITY + 1, NULL);
+    CREATE_TASK(cloud_send, cloud_send_task, "CloudSend", tskIDLE_PRIORITY + 1);
+}
+
+void create_uart_link_task(void) {
+    CREATE_TASK(uart_link, uart_link_task, "UartLink", tskIDLE_PRIORITY + 2);
+}
+
+void create_flash_log_task(void) {
+    CREATE_TASK(flash_log, FlashLogTask, "FlashLog", tskIDLE_PRIORITY + 1);
 }
 
 void create_all_tasks(void) {
@@ -79,5 +137,7 @@ void create_all_tasks(void) {
     create_alert_control_task();
     create_motion_detection_task();
     create_watchdog_task();
+    create_uart_link_task();
+    create_flash_log_task();
     create_cloud_send_task();
 }
\ No newline at end of file
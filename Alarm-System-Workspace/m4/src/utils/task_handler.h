@@ -3,7 +3,8 @@
 
 /*
  * Abstraction layer for creating and managing FreeRTOS tasks.
- * Tasks are created with appropriate stack sizes and priorities.
+ * Tasks are created with appropriate stack sizes and priorities,
+ * from static stacks and TCBs (no heap).
  * Allows for centralized task management.
  * Ensures modularity and easier maintenance.
 */
@@ -12,6 +13,8 @@ void create_LED_control_task(void);
 void create_alert_control_task(void);
 void create_watchdog_task(void);
 void create_cloud_send_task(void);
+void create_uart_link_task(void);
+void create_flash_log_task(void);
 void create_motion_detection_task(void);
 void create_all_tasks(void);
 
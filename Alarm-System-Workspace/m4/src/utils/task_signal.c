@@ -0,0 +1,44 @@
+#include "task_signal.h"
+
+
+void task_signal_raise(TaskHandle_t task, uint32_t bits)
+{
+    if (task != NULL) {
+        xTaskNotify(task, bits, eSetBits);
+    }
+}
+
+void task_signal_raise_from_isr(TaskHandle_t task, uint32_t bits, BaseType_t *woken)
+{
+    if (task != NULL) {
+        xTaskNotifyFromISR(task, bits, eSetBits, woken);
+    }
+}
+
+uint32_t task_signal_wait(uint32_t mask, TickType_t wait)
+{
+    TimeOut_t timeout;
+    uint32_t value = 0;
+    uint32_t others = 0;
+
+    vTaskSetTimeOutState(&timeout);
+
+    // Take the whole value each time so the notification never sits
+    // non-zero but not pending; bits outside mask are put back below
+    for (;;) {
+        if (xTaskNotifyWait(0, UINT32_MAX, &value, wait) != pdPASS) {
+            value = 0;
+            break;
+        }
+        others |= value & ~mask;
+        if ((value & mask) != 0 || xTaskCheckForTimeOut(&timeout, &wait) != pdFALSE) {
+            break;
+        }
+    }
+
+    if (others != 0) {
+        xTaskNotify(xTaskGetCurrentTaskHandle(), others, eSetBits);
+    }
+
+    return value & mask;
+}
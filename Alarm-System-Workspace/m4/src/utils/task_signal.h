@@ -0,0 +1,47 @@
+#ifndef TASK_SIGNAL_H
+#define TASK_SIGNAL_H
+
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "task.h"
+
+/*
+ * One-to-one wakeups carried as bit flags in the receiving task's direct
+ * notification value, instead of a kernel semaphore per event.
+ *
+ * Raising ORs the bits into the target's value (repeats of a bit before
+ * the task runs collapse into one, like a binary semaphore). Waiting
+ * returns and clears only the bits asked for; any other bits that arrived
+ * meanwhile stay pending for the task's next wait, so one task can wait
+ * on different bits at different points (e.g. TX_DONE inside a send, ACK
+ * in its main loop).
+ *
+ * Bits are unique across the firmware. A task using these must not use
+ * its notification for anything else (xTaskNotifyGive etc.).
+ */
+
+/* Motion task */
+#define TASK_SIGNAL_MOTION_EDGE      (1u << 0)   // GPIO ISR pushed an edge capture
+#define TASK_SIGNAL_MOTION_PROFILE   (1u << 1)   // Sensor profile requested
+#define TASK_SIGNAL_MOTION_STATE     (1u << 2)   // Alarm state changed
+#define TASK_SIGNAL_MOTION_REARM(i)  (1u << (3 + (i)))  // Activity cooldown over, sensor i
+#define TASK_SIGNAL_MOTION_REARM_ALL (0x1Fu << 3)       // Sensors 0-4
+
+/* UART sender (cloud send task) */
+#define TASK_SIGNAL_TX_DONE          (1u << 8)   // TX ring drained (UART0 ISR)
+#define TASK_SIGNAL_ACK              (1u << 9)   // Window ACK decoded by the link task
+#define TASK_SIGNAL_RESYNC           (1u << 10)  // Gateway lost its window state
+
+// Task context. Does nothing if task is NULL (not started yet).
+void task_signal_raise(TaskHandle_t task, uint32_t bits);
+
+// ISR context; sets *woken if a context switch is needed.
+void task_signal_raise_from_isr(TaskHandle_t task, uint32_t bits, BaseType_t *woken);
+
+/*
+ * Wait up to wait ticks for any of mask in the calling task's value.
+ * Returns the bits of mask that were set (and clears them), 0 on timeout.
+ */
+uint32_t task_signal_wait(uint32_t mask, TickType_t wait);
+
+#endif /* TASK_SIGNAL_H */
@@ -0,0 +1,42 @@
+#include "timestamp.h"
+#include "mxc_device.h"
+#include "tmr.h"
+
+/*
+ * TMR1 runs continuously in 32-bit mode from the peripheral clock.
+ * With a /16 prescaler on a 50 MHz APB clock that is 3.125 MHz
+ * (0.32 us resolution), wrapping roughly every 22 minutes.
+ */
+#define TIMESTAMP_TMR       MXC_TMR1
+#define TIMESTAMP_PRESCALER TMR_PRES_16
+#define TIMESTAMP_DIVIDER   16
+
+static uint32_t ticks_per_second = 1;
+
+void timestamp_init(void)
+{
+    mxc_tmr_cfg_t cfg = {
+        .pres    = TIMESTAMP_PRESCALER,
+        .mode    = TMR_MODE_CONTINUOUS,
+        .bitMode = TMR_BIT_MODE_32,
+        .clock   = MXC_TMR_APB_CLK,
+        .cmp_cnt = 0xFFFFFFFF,  // Run the full 32-bit range before reload
+        .pol     = 0
+    };
+
+    MXC_TMR_Shutdown(TIMESTAMP_TMR);
+    MXC_TMR_Init(TIMESTAMP_TMR, &cfg, false);
+    MXC_TMR_Start(TIMESTAMP_TMR);
+
+    ticks_per_second = PeripheralClock / TIMESTAMP_DIVIDER;
+}
+
+uint32_t timestamp_now(void)
+{
+    return MXC_TMR_GetCount(TIMESTAMP_TMR);
+}
+
+uint32_t timestamp_ticks_to_us(uint32_t ticks)
+{
+    return (uint32_t)(((uint64_t)ticks * 1000000u) / ticks_per_second);
+}
@@ -0,0 +1,21 @@
+#ifndef TIMESTAMP_H
+#define TIMESTAMP_H
+
+#include <stdint.h>
+
+/*
+ * High-resolution timestamps from a free-running hardware timer (TMR1).
+ * Safe to call from interrupt context. Raw values wrap, so only use
+ * them for differences (latencies, durations), not absolute time.
+ */
+
+// Start the free-running timer (call once before the scheduler starts)
+void timestamp_init(void);
+
+// Current raw timer count
+uint32_t timestamp_now(void);
+
+// Convert a raw tick difference to microseconds
+uint32_t timestamp_ticks_to_us(uint32_t ticks);
+
+#endif /* TIMESTAMP_H */
@@ -14,12 +14,13 @@ typedef enum warn_type {
     HIGH_WARN
 } warn_type;
 
-// -> received from UART ISR callback
+// -> received from UART link task callback
 typedef enum command_type {
     ARM,
     DISARM,
     RESOLVE_ALARM,
     CANCEL_WARN,
+    SET_PROFILE,     // arg = motion_profile, handled by the motion task
     UNKNOWN_COMMAND
 } command_type;
 
@@ -32,23 +33,45 @@ typedef enum alarm_state {
 	ALARM
 } alarm_state;
 
+// -> which member of an alert_event is valid
+typedef enum event_source {
+    EVENT_SOURCE_MOTION,
+    EVENT_SOURCE_COMMAND
+} event_source;
+
 // ===================== STRUCTS =====================
 
-// -> motion_queue contents
+// -> motion event (fused sensor decision)
 typedef struct motion_event {
     warn_type warning;
+    uint32_t capture_tick; // RTOS tick (ms) when the sensor edge was captured
+    uint8_t device_id; // sensor that produced the fused decision
 } motion_event;
 
-// -> command_queue contents
+// -> command event (from the gateway or the WARN timeout)
 typedef struct command_event {
     command_type cmd;
+    uint8_t arg; // command argument (SET_PROFILE only)
 } command_event;
 
+// -> event bus contents (see event_bus.h)
+typedef struct alert_event {
+    event_source source;
+    uint32_t timestamp; // RTOS tick (ms) of arrival: edge capture for motion, receipt for commands
+    union {
+        motion_event motion;
+        command_event command;
+    };
+} alert_event;
+
 // -> cloud_queue contents
 typedef struct cloud_update_event {
     unsigned int from_motion : 1; // boolean bitfield
     warn_type warning; // null if !from_motion
     alarm_state state;
+    uint32_t timestamp; // RTOS tick (ms) of the triggering event
+    uint8_t odr_code; // ADXL343 BW_RATE rate code for this state
+    uint8_t device_id; // source sensor if from_motion
 } cloud_update_event; 
 
 #endif /* TYPING_H */
\ No newline at end of file
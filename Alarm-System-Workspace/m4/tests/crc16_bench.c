@@ -0,0 +1,148 @@
+/*
+ * Host test and benchmark for the CRC-16 software paths (src/uart/crc16.c,
+ * built with CRC16_USE_HW=0).
+ *
+ * Checks the original byte-at-a-time crc_iterate table, slicing-by-4 and
+ * slicing-by-8 against a bit-by-bit reference over every length and
+ * alignment a link frame can have, then times them on the same
+ * frame-sized vectors as crc16_benchmark() uses on target.
+ *
+ *   make -C tests crc
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+#include "../src/uart/crc16.h"
+
+#define FRAME_MAX   300         // Longer than any frame (UART_MAX_DATA_LENGTH 255)
+#define BENCH_ROUNDS 200000
+
+static const char *impl_names[] = { "crc_iterate", "slice4", "slice8" };
+#define IMPLS (sizeof(impl_names) / sizeof(impl_names[0]))
+
+static uint8_t buf[FRAME_MAX + 8];
+static int failures = 0;
+
+// Poly 0x8408, one bit at a time: shares nothing with the tables
+static uint16_t reference(uint16_t crc, const uint8_t *p, size_t len)
+{
+    while (len--) {
+        crc ^= *p++;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 1) ? (crc >> 1) ^ 0x8408 : crc >> 1;
+        }
+    }
+    return crc;
+}
+
+// The link's original per-byte step (uart/crc.c before the crc16 module)
+static uint16_t crc_iterate(uint16_t crc, uint8_t byte)
+{
+    return (crc >> 8) ^ crc16_tables[0][(crc ^ byte) & 0xff];
+}
+
+static uint16_t run(size_t impl, uint16_t crc, const uint8_t *p, size_t len)
+{
+    if (impl == 0) {
+        while (len--) {
+            crc = crc_iterate(crc, *p++);
+        }
+        return crc;
+    }
+    return crc16_update_impl(impl == 1 ? CRC16_IMPL_SLICE4 : CRC16_IMPL_SLICE8, crc, p, len);
+}
+
+static void check(int ok, const char *what, size_t impl, size_t offset, size_t len)
+{
+    if (!ok && failures++ < 10) {
+        printf("FAIL %s: %s offset %zu len %zu\n", what, impl_names[impl], offset, len);
+    }
+}
+
+static void test_vectors(void)
+{
+    static const uint8_t check_str[] = "123456789";
+
+    // Standard check value for this variant (init 0xFFFF, no final XOR)
+    for (size_t impl = 0; impl < IMPLS; impl++) {
+        check(run(impl, CRC16_INIT, check_str, 9) == 0x6f91, "check value", impl, 0, 9);
+    }
+    check(crc16_compute(check_str, 9) == 0x6f91, "crc16_compute check value", 2, 0, 9);
+
+    // Every length at every alignment, in one call and split in two
+    for (size_t offset = 0; offset < 8; offset++) {
+        for (size_t len = 0; len <= FRAME_MAX; len++) {
+            const uint8_t *p = &buf[offset];
+            uint16_t expected = reference(CRC16_INIT, p, len);
+
+            for (size_t impl = 0; impl < IMPLS; impl++) {
+                check(run(impl, CRC16_INIT, p, len) == expected, "one call", impl, offset, len);
+
+                size_t cut = len / 3;
+                uint16_t crc = run(impl, CRC16_INIT, p, cut);
+                check(run(impl, crc, p + cut, len - cut) == expected, "split", impl, offset, len);
+            }
+        }
+    }
+}
+
+// Same vectors as crc16_benchmark(): command, update, batch, max frame
+static const struct { uint16_t offset; uint16_t len; } bench_vectors[] = {
+    { 1,   7 },
+    { 3,   14 },
+    { 5,   62 },
+    { 7,   255 },
+};
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void benchmark(void)
+{
+    double ns[IMPLS] = {0};
+    uint64_t bytes = 0;
+    volatile uint16_t sink = 0;
+
+    for (size_t v = 0; v < sizeof(bench_vectors) / sizeof(bench_vectors[0]); v++) {
+        const uint8_t *p = &buf[bench_vectors[v].offset];
+        size_t len = bench_vectors[v].len;
+
+        bytes += (uint64_t)len * BENCH_ROUNDS;
+        for (size_t impl = 0; impl < IMPLS; impl++) {
+            double start = now_ns();
+            for (int r = 0; r < BENCH_ROUNDS; r++) {
+                sink ^= run(impl, (uint16_t)r, p, len);
+            }
+            ns[impl] += now_ns() - start;
+        }
+    }
+
+    printf("%-12s %10s %8s\n", "impl", "ns/byte", "speedup");
+    for (size_t impl = 0; impl < IMPLS; impl++) {
+        printf("%-12s %10.3f %7.2fx\n", impl_names[impl], ns[impl] / bytes, ns[0] / ns[impl]);
+    }
+    (void)sink;
+}
+
+int main(void)
+{
+    uint32_t seed = 0x12345678;
+    for (size_t i = 0; i < sizeof(buf); i++) {
+        seed = seed * 1103515245u + 12345u;
+        buf[i] = seed >> 24;
+    }
+
+    test_vectors();
+    if (failures) {
+        printf("crc16: %d failures\n", failures);
+        return 1;
+    }
+    printf("crc16: all implementations agree with the bitwise reference\n");
+
+    benchmark();
+    return 0;
+}